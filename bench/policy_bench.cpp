@@ -0,0 +1,182 @@
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+#include "eigen3/Eigen/Core"
+#include "eigen3/Eigen/Geometry"
+
+#include "msync/supported_messages/eigen_quaternion.h"
+#include "msync/supported_messages/eigen_se3.h"
+#include "msync/supported_policies/cubic_interpolater.h"
+#include "msync/supported_policies/exact_time.h"
+#include "msync/supported_policies/linear_interpolater.h"
+#include "msync/supported_policies/nearest.h"
+#include "msync/supported_policies/newest.h"
+
+using namespace msync;
+
+using Quaternion = Eigen::Quaterniond;
+using SE3 = Eigen::Matrix<double, 7, 1>;
+
+// message at stamp t of a slowly turning, moving body
+
+template <typename _Msg> static _Msg message(const Time t);
+
+template <> double message<double>(const Time t) { return double(t); }
+
+template <> Quaternion message<Quaternion>(const Time t) {
+  return Quaternion(Eigen::AngleAxisd(t * 1e-3, Eigen::Vector3d(1, 2, 3)
+                                                     .normalized()));
+}
+
+template <> SE3 message<SE3>(const Time t) {
+  const Quaternion q = message<Quaternion>(t);
+  SE3 se3;
+  se3 << t * 1e-3, t * 2e-3, 0.0, q.w(), q.x(), q.y(), q.z();
+  return se3;
+}
+
+// doPeek of a policy holding 1000 messages 10 apart, peek times sweep over
+// them at a step of 7, so exact time hits one in ten
+template <typename _Policy>
+static void BM_PolicyPeek(benchmark::State &state) {
+  using Msg = typename PolicyTraits<_Policy>::MsgType;
+  constexpr Time kNum = 1000;
+  constexpr Time kStep = 10;
+
+  _Policy policy(kNum * kStep);
+  for (Time t = 0; t < kNum * kStep; t += kStep) {
+    policy.push(t, message<Msg>(t));
+  }
+
+  Time time = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(policy.doPeek(time));
+    time = time + 7 < (kNum - 1) * kStep ? time + 7 : 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_PolicyPeek, ExactTimePolicy<double>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, NearestPolicy<double>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, NewestPolicy<double>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, LinearInterpolatePolicy<double>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, LinearInterpolatePolicy<Quaternion>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, LinearInterpolatePolicy<SE3>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, FastLinearInterpolatePolicy<Quaternion>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, FastLinearInterpolatePolicy<SE3>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, CubicInterpolatePolicy<double>);
+BENCHMARK_TEMPLATE(BM_PolicyPeek, CubicInterpolatePolicy<SE3>);
+
+// peek times step by one, so ten peeks in a row fall in one segment, as
+// several slaves at one master stamp or retries after not ready do
+template <typename _Policy>
+static void BM_PolicyPeekSameSegment(benchmark::State &state) {
+  using Msg = typename PolicyTraits<_Policy>::MsgType;
+  constexpr Time kNum = 1000;
+  constexpr Time kStep = 10;
+
+  _Policy policy(kNum * kStep);
+  for (Time t = 0; t < kNum * kStep; t += kStep) {
+    policy.push(t, message<Msg>(t));
+  }
+
+  Time time = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(policy.doPeek(time));
+    time = time + 1 < (kNum - 1) * kStep ? time + 1 : 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_PolicyPeekSameSegment, LinearInterpolatePolicy<double>);
+BENCHMARK_TEMPLATE(BM_PolicyPeekSameSegment,
+                   LinearInterpolatePolicy<Quaternion>);
+BENCHMARK_TEMPLATE(BM_PolicyPeekSameSegment, LinearInterpolatePolicy<SE3>);
+BENCHMARK_TEMPLATE(BM_PolicyPeekSameSegment, CubicInterpolatePolicy<SE3>);
+
+// de-skew of a scan, range(0) per point stamps sorted over 100 messages,
+// peeked one by one or with one batch peek
+template <typename _Msg, bool _Batch>
+static void BM_PeekScan(benchmark::State &state) {
+  using Policy = LinearInterpolatePolicy<_Msg>;
+  const size_t n = state.range(0);
+  constexpr Time kStep = 1000;
+
+  Policy policy(100 * kStep);
+  for (Time t = 0; t < 100 * kStep; t += kStep) {
+    policy.push(t, message<_Msg>(t / 10));
+  }
+  std::vector<Time> times(n);
+  for (size_t i = 0; i < n; ++i) {
+    times[i] = Time(i * (99 * kStep) / n);
+  }
+  std::vector<typename Policy::OutType> outs(n);
+
+  for (auto _ : state) {
+    if (_Batch) {
+      policy.peekBatch(times.data(), n, outs.data());
+    } else {
+      for (size_t i = 0; i < n; ++i) {
+        outs[i] = policy.doPeek(times[i]);
+      }
+    }
+    benchmark::DoNotOptimize(outs.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_PeekScan, Quaternion, false)->Range(1024, 65536);
+BENCHMARK_TEMPLATE(BM_PeekScan, Quaternion, true)->Range(1024, 65536);
+BENCHMARK_TEMPLATE(BM_PeekScan, SE3, false)->Range(1024, 65536);
+BENCHMARK_TEMPLATE(BM_PeekScan, SE3, true)->Range(1024, 65536);
+
+// the two operations of linear interpolater traits, at a small rotation
+template <typename _Msg>
+static void BM_InterpolaterTraits(benchmark::State &state) {
+  using Traits = LinearInterpolaterTraits<_Msg>;
+  const _Msg from = message<_Msg>(0);
+  const _Msg to = message<_Msg>(10);
+
+  for (auto _ : state) {
+    const auto tangent = Traits::between(from, to);
+    benchmark::DoNotOptimize(Traits::plus(from, tangent * 0.5));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_InterpolaterTraits, double);
+BENCHMARK_TEMPLATE(BM_InterpolaterTraits, Quaternion);
+BENCHMARK_TEMPLATE(BM_InterpolaterTraits, SE3);
+
+// the same with fast interpolater traits, plus only with the tangent of a
+// segment precomputed, as a policy does for peeks in one segment
+template <typename _Msg>
+static void BM_FastInterpolaterTraits(benchmark::State &state) {
+  using Traits = FastInterpolaterTraits<_Msg>;
+  const _Msg from = message<_Msg>(0);
+  const _Msg to = message<_Msg>(10);
+
+  for (auto _ : state) {
+    const auto tangent = Traits::between(from, to);
+    benchmark::DoNotOptimize(Traits::plus(from, tangent * 0.5));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_FastInterpolaterTraits, Quaternion);
+BENCHMARK_TEMPLATE(BM_FastInterpolaterTraits, SE3);
+
+template <typename _Traits, typename _Msg>
+static void BM_InterpolaterPlus(benchmark::State &state) {
+  const _Msg from = message<_Msg>(0);
+  const auto tangent = _Traits::between(from, message<_Msg>(10));
+
+  double ratio = 0.0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(_Traits::plus(from, tangent * ratio));
+    ratio = ratio < 1.0 ? ratio + 0.01 : 0.0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_InterpolaterPlus, LinearInterpolaterTraits<Quaternion>,
+                   Quaternion);
+BENCHMARK_TEMPLATE(BM_InterpolaterPlus, FastInterpolaterTraits<Quaternion>,
+                   Quaternion);
+BENCHMARK_TEMPLATE(BM_InterpolaterPlus, LinearInterpolaterTraits<SE3>, SE3);
+BENCHMARK_TEMPLATE(BM_InterpolaterPlus, FastInterpolaterTraits<SE3>, SE3);
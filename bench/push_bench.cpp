@@ -0,0 +1,331 @@
+#include "benchmark/benchmark.h"
+
+#include <type_traits>
+
+#include "msync/arena_policy_array.h"
+#include "msync/supported_policies/exact_time.h"
+#include "msync/supported_policies/linear_interpolater.h"
+#include "msync/supported_policies/nearest.h"
+#include "msync/supported_storages/ring_storage.h"
+#include "msync/supported_storages/slice_storage.h"
+#include "msync/syncronizer.h"
+
+using namespace msync;
+
+// per push cost of a master slave synchronizer, master at 10 step, slaves
+// at 1 step, every master push emits
+template <typename _Slave>
+static void BM_MasterSlavePush(benchmark::State &state) {
+  using Master = ExactTimePolicy<double>;
+  using Sync = SyncronizerMasterSlave<Master, _Slave, _Slave>;
+
+  Sync sync(Master(1000, kMaster), _Slave(1000), _Slave(1000));
+  size_t emitted = 0;
+  sync.registerCallback(
+      [&](const Time, const std::pair<double, bool> &,
+          const std::pair<double, bool> &,
+          const std::pair<double, bool> &) { ++emitted; });
+
+  Time time = 0;
+  for (auto _ : state) {
+    sync.template push<1>(time, double(time));
+    sync.template push<2>(time, double(time));
+    if (time % 10 == 0) {
+      sync.template push<0>(time, double(time));
+    }
+    ++time;
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(state.iterations() * 2 + time / 10);
+}
+BENCHMARK_TEMPLATE(BM_MasterSlavePush, ExactTimePolicy<double>);
+BENCHMARK_TEMPLATE(BM_MasterSlavePush, NearestPolicy<double>);
+BENCHMARK_TEMPLATE(BM_MasterSlavePush, LinearInterpolatePolicy<double>);
+
+// per push cost of a min interval synchronizer over two exact time streams
+static void BM_MinIntervalPush(benchmark::State &state) {
+  using Policy = ExactTimePolicy<double>;
+  using Sync = SyncronizerMinInterval<Policy, Policy>;
+
+  Sync sync(5, Policy(1000), Policy(1000));
+  size_t emitted = 0;
+  sync.registerCallback([&](const Time, const std::pair<double, bool> &,
+                            const std::pair<double, bool> &) { ++emitted; });
+
+  Time time = 0;
+  for (auto _ : state) {
+    sync.push<0>(time, double(time));
+    sync.push<1>(time, double(time));
+    ++time;
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_MinIntervalPush);
+
+// same as BM_MinIntervalPush, with callback inlined instead of std::function
+static void BM_MinIntervalPushInlineCallback(benchmark::State &state) {
+  using Policy = ExactTimePolicy<double>;
+
+  size_t emitted = 0;
+  auto sync = makeSyncronizerMinInterval(
+      5,
+      [&](const Time, const std::pair<double, bool> &,
+          const std::pair<double, bool> &) { ++emitted; },
+      Policy(1000), Policy(1000));
+
+  Time time = 0;
+  for (auto _ : state) {
+    sync.push<0>(time, double(time));
+    sync.push<1>(time, double(time));
+    ++time;
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_MinIntervalPushInlineCallback);
+
+// per push cost of a homogeneous master slave synchronizer over 12 cameras,
+// each candidate peeks all of them
+static void BM_HomoMasterSlavePush(benchmark::State &state) {
+  using Policy = NearestPolicy<double>;
+  using Sync = HomoSyncronizerMasterSlave<Policy>;
+
+  std::vector<Policy> policies{Policy(1000, 10, kMaster)};
+  for (int i = 1; i < 12; ++i) {
+    policies.emplace_back(Policy(1000, 10));
+  }
+  Sync sync(policies);
+
+  size_t emitted = 0;
+  sync.registerCallback(
+      [&](const Time, const std::vector<std::pair<double, bool>> &) {
+        ++emitted;
+      });
+
+  Time time = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 12; ++i) {
+      sync.push(time + i, {double(time), i});
+    }
+    time += 20;
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(state.iterations() * 12);
+}
+BENCHMARK(BM_HomoMasterSlavePush);
+
+// master slave synchronizer over a 64 channel array, per channel policies
+// (arg 0) or one arena for all channels (arg 1)
+template <bool _Arena>
+static void BM_ChannelArrayPush(benchmark::State &state) {
+  using Msg = double;
+  using Alloc = std::allocator<std::pair<const Time, Msg>>;
+  using Policy = std::conditional_t<
+      _Arena, NearestPolicy<Msg, Alloc, SliceStorage<Msg>>, NearestPolicy<Msg>>;
+  using Array = std::conditional_t<_Arena, ArenaPolicyArray<Policy, 64>,
+                                   PolicyArray<Policy>>;
+  using Sync = SyncronizerMasterSlave<ExactTimePolicy<Msg>, Array>;
+
+  Array array = [] {
+    if constexpr (_Arena) {
+      return Array(Policy(1000, 10), 16);
+    } else {
+      return Array(std::vector<Policy>(64, Policy(1000, 10)));
+    }
+  }();
+  Sync sync(ExactTimePolicy<Msg>(1000, kMaster), std::move(array));
+
+  size_t emitted = 0;
+  sync.registerCallback(
+      [&](const Time, const std::pair<Msg, bool> &,
+          const std::vector<std::pair<Msg, bool>> &) { ++emitted; });
+
+  Time time = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 64; ++i) {
+      sync.template push<1>(time + i, {double(time), i});
+    }
+    sync.template push<0>(time + 32, double(time));
+    time += 100;
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(state.iterations() * 65);
+}
+BENCHMARK_TEMPLATE(BM_ChannelArrayPush, false);
+BENCHMARK_TEMPLATE(BM_ChannelArrayPush, true);
+
+using RingNearestPolicy =
+    NearestPolicy<double, std::allocator<std::pair<const Time, double>>,
+                  RingStorage<double>>;
+
+// replay one second of a 100Hz master with two 1kHz slaves, stamps in
+// microsecond, pushed merged by stamp (arg 0) or with pushBatches (arg 1)
+template <typename _Policy>
+static void BM_MasterSlaveReplay(benchmark::State &state) {
+  using Policy = _Policy;
+  using Sync = SyncronizerMasterSlave<Policy, Policy, Policy>;
+  using Stream = std::vector<std::pair<Time, double>>;
+
+  Stream master, slave;
+  for (Time t = 0; t < 1000000; t += 1000) {
+    slave.emplace_back(t, double(t));
+    if (t % 10000 == 0) {
+      master.emplace_back(t, double(t));
+    }
+  }
+
+  size_t emitted = 0;
+  for (auto _ : state) {
+    Sync sync(Policy(1e5, 500, kMaster), Policy(1e5, 500),
+              Policy(1e5, 500));
+    sync.registerCallback(
+        [&](const Time, const std::pair<double, bool> &,
+            const std::pair<double, bool> &,
+            const std::pair<double, bool> &) { ++emitted; });
+
+    if (state.range(0)) {
+      sync.pushBatches(master, slave, slave);
+    } else {
+      size_t m = 0;
+      for (const auto &[time, msg] : slave) {
+        if (m < master.size() && master[m].first <= time) {
+          sync.template push<0>(master[m].first, master[m].second);
+          ++m;
+        }
+        sync.template push<1>(time, msg);
+        sync.template push<2>(time, msg);
+      }
+    }
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(state.iterations() *
+                          (master.size() + 2 * slave.size()));
+}
+BENCHMARK_TEMPLATE(BM_MasterSlaveReplay, NearestPolicy<double>)
+    ->Arg(0)
+    ->Arg(1);
+BENCHMARK_TEMPLATE(BM_MasterSlaveReplay, RingNearestPolicy)->Arg(0)->Arg(1);
+
+using RingExactTimePolicy =
+    ExactTimePolicy<double, std::allocator<std::pair<const Time, double>>,
+                    RingStorage<double>>;
+
+// jittered stamps of three streams at different rates
+static std::vector<std::vector<Time>> approximateTimeStreams() {
+  uint32_t seed = 11;
+  std::vector<std::vector<Time>> streams(3);
+  for (int i = 0; i < 3; ++i) {
+    for (Time t = 3 * i; t < 100000;) {
+      streams[i].emplace_back(t);
+      seed = seed * 1664525u + 1013904223u;
+      t += 10 + 7 * i + (seed >> 16) % 9;
+    }
+  }
+  return streams;
+}
+
+// approximate time syncronizer fed in stamp order
+template <typename _Policy>
+static void BM_ApproximateTimePush(benchmark::State &state) {
+  using Policy = _Policy;
+  using Out = std::pair<double, bool>;
+  using Sync = SyncronizerApproximateTime<Policy, Policy, Policy>;
+
+  const auto streams = approximateTimeStreams();
+  size_t emitted = 0, items = 0;
+  for (auto _ : state) {
+    Sync sync(Policy(1000), Policy(1000), Policy(1000));
+    sync.registerCallback(
+        [&](const Time, const Out &, const Out &, const Out &) { ++emitted; });
+
+    std::vector<size_t> pos(3, 0);
+    while (true) {
+      int idx = -1;
+      for (int i = 0; i < 3; ++i) {
+        if (pos[i] < streams[i].size() &&
+            (idx < 0 || streams[i][pos[i]] < streams[idx][pos[idx]]))
+          idx = i;
+      }
+      if (idx < 0)
+        break;
+      const Time time = streams[idx][pos[idx]++];
+      if (idx == 0)
+        sync.template push<0>(time, double(time));
+      else if (idx == 1)
+        sync.template push<1>(time, double(time));
+      else
+        sync.template push<2>(time, double(time));
+      ++items;
+    }
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(items);
+}
+BENCHMARK_TEMPLATE(BM_ApproximateTimePush, ExactTimePolicy<double>);
+BENCHMARK_TEMPLATE(BM_ApproximateTimePush, RingExactTimePolicy);
+
+// brute force reference with all stamps known in advance, for each pivot
+// every start stamp is tried with the first message of each stream no
+// earlier than it
+static void BM_ApproximateTimeBruteForce(benchmark::State &state) {
+  const auto streams = approximateTimeStreams();
+  size_t emitted = 0, items = 0;
+  for (auto _ : state) {
+    std::vector<size_t> pos(3, 0);
+    while (true) {
+      size_t pivot = 0;
+      bool done = false;
+      for (size_t i = 0; i < 3; ++i) {
+        done |= pos[i] == streams[i].size();
+        if (!done && streams[i][pos[i]] > streams[pivot][pos[pivot]])
+          pivot = i;
+      }
+      if (done)
+        break;
+      const Time pivot_time = streams[pivot][pos[pivot]];
+
+      std::vector<size_t> best, set(3);
+      Time best_spread = std::numeric_limits<Time>::max();
+      Time best_start = 0;
+      for (size_t j = 0; j < 3; ++j) {
+        for (size_t k = pos[j];
+             k < streams[j].size() && streams[j][k] <= pivot_time; ++k) {
+          const Time start = streams[j][k];
+          Time end = start;
+          bool full = true;
+          for (size_t i = 0; i < 3 && full; ++i) {
+            set[i] = std::lower_bound(streams[i].begin() + pos[i],
+                                      streams[i].end(), start) -
+                     streams[i].begin();
+            full = set[i] < streams[i].size();
+            end = full ? std::max(end, streams[i][set[i]]) : end;
+          }
+          if (full && (end - start < best_spread ||
+                       (end - start == best_spread && start < best_start))) {
+            best_spread = end - start;
+            best_start = start;
+            best = set;
+          }
+        }
+      }
+
+      for (size_t i = 0; i < 3; ++i) {
+        pos[i] = best[i] + 1;
+      }
+      ++emitted;
+    }
+    items += streams[0].size() + streams[1].size() + streams[2].size();
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(items);
+}
+BENCHMARK(BM_ApproximateTimeBruteForce);
@@ -0,0 +1,134 @@
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "eigen3/Eigen/Core"
+#include "eigen3/Eigen/Geometry"
+
+#include "msync/supported_messages/eigen_quaternion.h"
+#include "msync/supported_messages/eigen_se3.h"
+#include "msync/supported_policies/exact_time.h"
+#include "msync/supported_policies/linear_interpolater.h"
+#include "msync/supported_policies/nearest.h"
+#include "msync/syncronizer.h"
+
+using namespace msync;
+
+// a vehicle sensor rig, stamps in microseconds: 200Hz imu poses, 10Hz
+// lidar, three 30Hz cameras with their own phase and some jitter
+
+using SE3 = Eigen::Matrix<double, 7, 1>;
+
+using Imu = LinearInterpolatePolicy<SE3>;
+using Lidar = ExactTimePolicy<int>;
+using Camera = NearestPolicy<int>;
+
+enum Sensor { kImu = 0, kLidar, kCamera0, kCamera1, kCamera2 };
+
+struct Event {
+  Time time;
+  Sensor sensor;
+};
+
+// ten seconds of arrivals in stamp order
+static const std::vector<Event> &sensorEvents() {
+  static const std::vector<Event> events = [] {
+    constexpr Time kDuration = 10000000;
+    std::vector<Event> events;
+    for (Time t = 0; t < kDuration; t += 5000) {
+      events.push_back({t, kImu});
+    }
+    for (Time t = 0; t < kDuration; t += 100000) {
+      events.push_back({t, kLidar});
+    }
+    uint32_t seed = 5;
+    for (int i = 0; i < 3; ++i) {
+      for (Time t = 3000 * (i + 1); t < kDuration; t += 33333) {
+        seed = seed * 1664525u + 1013904223u;
+        events.push_back({t + Time(seed >> 16) % 1000 - 500,
+                          Sensor(kCamera0 + i)});
+      }
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event &a, const Event &b) {
+                       return a.time < b.time;
+                     });
+    return events;
+  }();
+  return events;
+}
+
+static SE3 imuPose(const Time t) {
+  const Eigen::Quaterniond q(
+      Eigen::AngleAxisd(t * 1e-6, Eigen::Vector3d::UnitZ()));
+  SE3 pose;
+  pose << t * 1e-5, 0.0, 0.0, q.w(), q.x(), q.y(), q.z();
+  return pose;
+}
+
+template <typename _Sync> static void replay(_Sync &sync) {
+  for (const auto &event : sensorEvents()) {
+    switch (event.sensor) {
+    case kImu:
+      sync.template push<0>(event.time, imuPose(event.time));
+      break;
+    case kLidar:
+      sync.template push<1>(event.time, 0);
+      break;
+    case kCamera0:
+      sync.template push<2>(event.time, 0);
+      break;
+    case kCamera1:
+      sync.template push<3>(event.time, 0);
+      break;
+    case kCamera2:
+      sync.template push<4>(event.time, 0);
+      break;
+    }
+  }
+}
+
+// every lidar scan with imu pose and the nearest image of each camera
+static void BM_SensorMasterSlave(benchmark::State &state) {
+  size_t emitted = 0;
+  auto cb = [&](const Time, const std::pair<SE3, bool> &,
+                const std::pair<int, bool> &, const std::pair<int, bool> &,
+                const std::pair<int, bool> &,
+                const std::pair<int, bool> &) { ++emitted; };
+
+  for (auto _ : state) {
+    auto sync = makeSyncronizerMasterSlave(
+        cb, Imu(1000000, 10000), Lidar(1000000, kMaster),
+        Camera(1000000, 20000), Camera(1000000, 20000),
+        Camera(1000000, 20000));
+    replay(sync);
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(state.iterations() * sensorEvents().size());
+}
+BENCHMARK(BM_SensorMasterSlave);
+
+// any stamp at least 50ms after the last emission, lidar is then also
+// peeked for the nearest scan
+static void BM_SensorMinInterval(benchmark::State &state) {
+  size_t emitted = 0;
+  auto cb = [&](const Time, const std::pair<SE3, bool> &,
+                const std::pair<int, bool> &, const std::pair<int, bool> &,
+                const std::pair<int, bool> &,
+                const std::pair<int, bool> &) { ++emitted; };
+
+  for (auto _ : state) {
+    auto sync = makeSyncronizerMinInterval(
+        50000, cb, Imu(1000000, 10000), Camera(1000000, 50000),
+        Camera(1000000, 20000), Camera(1000000, 20000),
+        Camera(1000000, 20000));
+    replay(sync);
+  }
+
+  benchmark::DoNotOptimize(emitted);
+  state.SetItemsProcessed(state.iterations() * sensorEvents().size());
+}
+BENCHMARK(BM_SensorMinInterval);
@@ -0,0 +1,137 @@
+#include "benchmark/benchmark.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "msync/supported_allocators/pool_allocator.h"
+#include "msync/supported_storages/map_storage.h"
+#include "msync/supported_storages/mapped_storage.h"
+#include "msync/supported_storages/ring_storage.h"
+
+using namespace msync;
+
+// storages holding range(0) items one stamp apart
+
+template <typename _Storage> static _Storage filledStorage(const Time n) {
+  _Storage storage(n - 1);
+  for (Time t = 0; t < n; ++t) {
+    storage.push(t, double(t));
+  }
+  return storage;
+}
+
+// query stamps spread over the storage in random order
+static std::vector<Time> randomStamps(const Time n) {
+  std::vector<Time> stamps(1024);
+  uint32_t seed = 1;
+  for (auto &stamp : stamps) {
+    seed = seed * 1664525u + 1013904223u;
+    stamp = (seed >> 8) % n;
+  }
+  return stamps;
+}
+
+// push in steady state, every push evicts the oldest item
+template <typename _Storage>
+static void BM_StoragePush(benchmark::State &state) {
+  const Time n = state.range(0);
+  _Storage storage = filledStorage<_Storage>(n);
+
+  Time time = n;
+  for (auto _ : state) {
+    storage.push(time, double(time));
+    ++time;
+  }
+
+  benchmark::DoNotOptimize(storage.size());
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename _Storage>
+static void BM_StorageFind(benchmark::State &state) {
+  const Time n = state.range(0);
+  const _Storage storage = filledStorage<_Storage>(n);
+  const auto stamps = randomStamps(n);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(storage.find(stamps[i++ & 1023]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename _Storage>
+static void BM_StorageFindPre(benchmark::State &state) {
+  const Time n = state.range(0);
+  const _Storage storage = filledStorage<_Storage>(n);
+  const auto stamps = randomStamps(n);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(storage.findPre(stamps[i++ & 1023]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename _Storage>
+static void BM_StorageFindSuc(benchmark::State &state) {
+  const Time n = state.range(0);
+  const _Storage storage = filledStorage<_Storage>(n);
+  const auto stamps = randomStamps(n);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(storage.findSuc(stamps[i++ & 1023]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// queries moving forward one stamp at a time, as synchronizers do
+template <typename _Storage>
+static void BM_StorageFindPreSequential(benchmark::State &state) {
+  const Time n = state.range(0);
+  const _Storage storage = filledStorage<_Storage>(n);
+
+  Time time = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(storage.findPre(time));
+    time = time + 1 < n ? time + 1 : 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+using Map = MapStorage<double>;
+using Ring = RingStorage<double>;
+using Mapped = MappedStorage<double>;
+
+#define MSYNC_STORAGE_BENCHMARK(bm)                                            \
+  BENCHMARK_TEMPLATE(bm, Map)->RangeMultiplier(16)->Range(16, 65536);          \
+  BENCHMARK_TEMPLATE(bm, Ring)->RangeMultiplier(16)->Range(16, 65536);         \
+  BENCHMARK_TEMPLATE(bm, Mapped)->RangeMultiplier(16)->Range(16, 65536)
+
+MSYNC_STORAGE_BENCHMARK(BM_StoragePush);
+MSYNC_STORAGE_BENCHMARK(BM_StorageFind);
+MSYNC_STORAGE_BENCHMARK(BM_StorageFindPre);
+MSYNC_STORAGE_BENCHMARK(BM_StorageFindSuc);
+MSYNC_STORAGE_BENCHMARK(BM_StorageFindPreSequential);
+
+// steady state push of map storage with nodes from a pool
+static void BM_PoolMapPush(benchmark::State &state) {
+  using Alloc = PoolAllocator<std::pair<const Time, double>>;
+  const Time n = state.range(0);
+  MapStorage<double, Alloc> storage(n - 1,
+                                    Alloc(NodePool::capacityFor(n - 1, 1)));
+  for (Time t = 0; t < n; ++t) {
+    storage.push(t, double(t));
+  }
+
+  Time time = n;
+  for (auto _ : state) {
+    storage.push(time, double(time));
+    ++time;
+  }
+
+  benchmark::DoNotOptimize(storage.size());
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PoolMapPush)->RangeMultiplier(16)->Range(16, 65536);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "policy.h"
+#include "supported_storages/slice_storage.h"
+
+namespace msync {
+
+template <typename _Policy, size_t _N = 0> struct ArenaPolicyArray;
+
+template <typename _Policy, size_t _N>
+struct PolicyTraits<ArenaPolicyArray<_Policy, _N>>
+    : public PolicyTraits<PolicyArray<_Policy>> {};
+
+// PolicyArray whose policies keep messages in one arena instead of a
+// storage each. Policies must use SliceStorage, channel i holds up to
+// capacity messages in slots [i * capacity, (i + 1) * capacity) of a stamp
+// arena and an item arena, two allocations for all channels, made at
+// construction. Stamps searched by sucTime and peek of neighbouring
+// channels are close to each other, and no allocation happens after
+// construction. A full channel drops its oldest message for a new one, it
+// is counted by droppedCount of the channel. If _N is not 0 the array is
+// made of _N copies of one policy, arenas are still sized at run time.
+template <typename _Policy, size_t _N>
+struct ArenaPolicyArray : public PolicyArray<_Policy> {
+  using Base = PolicyArray<_Policy>;
+  using Policy = _Policy;
+  using Storage = typename PolicyTraits<Policy>::Storage;
+  using MsgType = typename PolicyTraits<Policy>::MsgType;
+  using Item = typename Storage::Item;
+
+  static_assert(std::is_same_v<Storage, SliceStorage<MsgType>>,
+                "policies of arena policy array must use SliceStorage");
+
+  static constexpr size_t kNumChannels = _N;
+
+  using Base::policies_;
+
+  // _N channels all copied from policy
+  ArenaPolicyArray(const Policy &policy, const size_t capacity)
+      : Base(std::vector<Policy>(_N, policy)), capacity_(capacity),
+        stamps_(_N * capacity), items_(_N * capacity) {
+    static_assert(_N > 0, "number of channels is not fixed, pass policies");
+    bind();
+  }
+
+  // one channel for each of policies
+  ArenaPolicyArray(const std::vector<Policy> &policies, const size_t capacity)
+      : Base(policies), capacity_(capacity),
+        stamps_(policies.size() * capacity),
+        items_(policies.size() * capacity) {
+    static_assert(_N == 0, "number of channels is fixed, pass one policy");
+    bind();
+  }
+
+  // storages of a copy are bound to its own arena
+  ArenaPolicyArray(const ArenaPolicyArray &other)
+      : Base(other), capacity_(other.capacity_), stamps_(other.stamps_),
+        items_(other.items_) {
+    bind();
+  }
+
+  ArenaPolicyArray(ArenaPolicyArray &&other)
+      : Base(std::move(other)), capacity_(other.capacity_),
+        stamps_(std::move(other.stamps_)), items_(std::move(other.items_)) {
+    bind();
+  }
+
+  ArenaPolicyArray &operator=(const ArenaPolicyArray &other) {
+    Base::operator=(other);
+    capacity_ = other.capacity_;
+    stamps_ = other.stamps_;
+    items_ = other.items_;
+    bind();
+    return *this;
+  }
+
+  ArenaPolicyArray &operator=(ArenaPolicyArray &&other) {
+    Base::operator=(std::move(other));
+    capacity_ = other.capacity_;
+    stamps_ = std::move(other.stamps_);
+    items_ = std::move(other.items_);
+    bind();
+    return *this;
+  }
+
+  size_t capacity() const { return capacity_; }
+
+protected:
+  void bind() {
+    for (size_t i = 0; i < policies_.size(); ++i) {
+      policies_[i].storage().bind(stamps_.data() + i * capacity_,
+                                  items_.data() + i * capacity_, capacity_);
+    }
+  }
+
+protected:
+  size_t capacity_;
+  std::vector<Time> stamps_;
+  std::vector<Item> items_;
+};
+
+} // namespace msync
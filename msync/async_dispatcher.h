@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "syncronizer.h"
+
+namespace msync {
+
+// true if out type points into policy storage, i.e. from a kPeekRef policy,
+// such out is only valid during the callback and can not be queued
+template <typename _T> struct IsBorrowedOut : std::false_type {};
+
+template <typename _Msg>
+struct IsBorrowedOut<std::pair<const _Msg *, bool>> : std::true_type {};
+
+template <typename _T, typename _Alloc>
+struct IsBorrowedOut<std::vector<_T, _Alloc>> : IsBorrowedOut<_T> {};
+
+// Hand emitted messages to a bounded queue served by worker threads, so a
+// slow callback does not stall the pushing thread. When the queue is full,
+// post blocks or drops according to overflow policy. Each emission is
+// tagged with a sequence number in emission order, with one worker the
+// callback sees them in that order, with more workers order is up to the
+// callback.
+template <typename... _Outs> struct AsyncDispatcher {
+  static_assert(!(IsBorrowedOut<_Outs>::value || ...),
+                "ref peek policies can not be dispatched asynchronously");
+
+  using CallbackFunction =
+      std::function<void(const uint64_t seq, const Time time,
+                         const _Outs &...msgs)>;
+
+  // status of each post, called on the posting thread
+  using StatusFunction = std::function<void(
+      const uint64_t seq, const Time time, const StatusCode status)>;
+
+  // callable posting to a dispatcher, to be the callback of a syncronizer
+  // made by makeSyncronizer*
+  struct Poster {
+    void operator()(const Time time, const _Outs &...msgs) const {
+      dispatcher->post(time, msgs...);
+    }
+
+    AsyncDispatcher *dispatcher;
+  };
+
+  AsyncDispatcher(const CallbackFunction &cb, const size_t capacity,
+                  const size_t num_workers = 1,
+                  const OverflowPolicy overflow = kOverflowBlock)
+      : cb_(cb), capacity_(capacity > 0 ? capacity : 1), overflow_(overflow),
+        seq_(0), active_(0), stop_(false), dropped_(0) {
+    for (size_t i = 0; i < std::max<size_t>(num_workers, 1); ++i) {
+      workers_.emplace_back([this] { work(); });
+    }
+  }
+
+  AsyncDispatcher(const AsyncDispatcher &) = delete;
+  AsyncDispatcher &operator=(const AsyncDispatcher &) = delete;
+
+  // run what is queued, then join workers
+  ~AsyncDispatcher() { stop(); }
+
+  // queue one emission, return kDispatchAccepted, kDispatchReplaced if the
+  // oldest queued one is dropped for it, or kDispatchDropped
+  StatusCode post(const Time time, const _Outs &...msgs) {
+    uint64_t seq;
+    const StatusCode status = enqueue(seq, time, msgs...);
+    if (status_cb_) {
+      status_cb_(seq, time, status);
+    }
+    return status;
+  }
+
+  // statuses of posts made through attach or poster are only seen here,
+  // set it before anything is posted
+  void registerStatusCallback(const StatusFunction &cb) { status_cb_ = cb; }
+
+  // dispatch everything emitted by sync, its callback is replaced
+  template <typename _Sync> void attach(_Sync &sync) {
+    sync.registerCallback(poster());
+  }
+
+  Poster poster() { return Poster{this}; }
+
+  // wait until every queued emission has been handled
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty() && active_ == 0; });
+  }
+
+  // refuse further posts, run what is queued and join workers. called from
+  // a callback it only refuses posts, the worker running it is joined by a
+  // later stop from another thread or by the destructor
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+
+    const auto self = std::this_thread::get_id();
+    for (const auto &worker : workers_) {
+      if (worker.get_id() == self) {
+        return;
+      }
+    }
+    std::lock_guard<std::mutex> lock(join_mutex_);
+    for (auto &worker : workers_) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+  }
+
+  size_t droppedCount() const { return dropped_.load(); }
+
+  size_t queueSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+  }
+
+protected:
+  using Item = std::tuple<uint64_t, Time, _Outs...>;
+
+  StatusCode enqueue(uint64_t &seq, const Time time, const _Outs &...msgs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    seq = seq_++;
+
+    StatusCode status = kDispatchAccepted;
+    if (overflow_ == kOverflowBlock) {
+      not_full_.wait(lock,
+                     [this] { return stop_ || queue_.size() < capacity_; });
+    }
+    if (stop_) {
+      ++dropped_;
+      return kDispatchDropped;
+    }
+    if (queue_.size() >= capacity_) {
+      if (overflow_ == kOverflowDropNewest) {
+        ++dropped_;
+        return kDispatchDropped;
+      }
+      queue_.pop_front();
+      ++dropped_;
+      status = kDispatchReplaced;
+    }
+
+    queue_.emplace_back(seq, time, msgs...);
+    not_empty_.notify_one();
+    return status;
+  }
+
+  void work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      not_empty_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+
+      Item item = std::move(queue_.front());
+      queue_.pop_front();
+      ++active_;
+      not_full_.notify_one();
+
+      lock.unlock();
+      if (cb_) {
+        std::apply(cb_, item);
+      }
+      lock.lock();
+
+      --active_;
+      if (queue_.empty() && active_ == 0) {
+        idle_.notify_all();
+      }
+    }
+  }
+
+protected:
+  CallbackFunction cb_;
+  StatusFunction status_cb_;
+  const size_t capacity_;
+  const OverflowPolicy overflow_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::condition_variable idle_;
+  std::deque<Item> queue_;
+  uint64_t seq_;
+  size_t active_;
+  bool stop_;
+  std::atomic<size_t> dropped_;
+
+  std::mutex join_mutex_;
+  std::vector<std::thread> workers_;
+};
+
+template <typename _PolicyTuple> struct AsyncDispatcherOfHelper;
+
+template <typename... _Polices>
+struct AsyncDispatcherOfHelper<std::tuple<_Polices...>> {
+  using type = AsyncDispatcher<typename PolicyTraits<_Polices>::OutType...>;
+};
+
+// dispatcher matching the emitted messages of syncronizer _Sync
+template <typename _Sync>
+using AsyncDispatcherOf = typename AsyncDispatcherOfHelper<
+    typename SyncronizerTraits<_Sync>::PolicyTuple>::type;
+
+} // namespace msync
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "syncronizer.h"
+
+namespace msync {
+
+// Lock free multi producer single consumer queue (Vyukov's node based one).
+// Any thread could push, only one thread at a time may pop. Per producer
+// order is kept.
+template <typename _T> struct MpscQueue {
+  struct Node {
+    std::atomic<Node *> next;
+    _T value;
+  };
+
+  MpscQueue() : stub_(new Node{{nullptr}, _T()}), head_(stub_), tail_(stub_) {}
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  ~MpscQueue() {
+    _T value;
+    while (pop(value)) {
+    }
+    delete tail_;
+  }
+
+  void push(_T &&value) {
+    Node *node = new Node{{nullptr}, std::move(value)};
+    Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // false if empty, or the newest producer has not finished linking
+  bool pop(_T &value) {
+    Node *tail = tail_;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    value = std::move(next->value);
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+private:
+  Node *stub_;
+  std::atomic<Node *> head_;
+  Node *tail_;
+};
+
+// Wrap a syncronizer so that it could be pushed from many threads. Each
+// policy gets its own lock free ingestion queue, pushes only enqueue and
+// never block. Matching runs on one thread at a time, either the pushing
+// thread which wins the try-lock, or a dedicated matcher thread calling
+// poll() when drive on push is disabled. Callback runs on the matching
+// thread.
+template <typename _Sync> struct ConcurrentSyncronizer {
+  using Syncronizer = _Sync;
+
+  static constexpr size_t kNumPolicies = Syncronizer::kNumPolicies;
+
+  template <size_t _Idx>
+  using PolicyInType = typename Syncronizer::template PolicyInType<_Idx>;
+
+  // construct the wrapped syncronizer in place from args
+  template <typename... _Args>
+  ConcurrentSyncronizer(_Args &&...args)
+      : sync_(std::forward<_Args>(args)...), drive_on_push_(true), pending_(0),
+        dropped_(0), busy_(false) {}
+
+  // safe from any thread, message is matched later by the matching thread
+  template <size_t _Idx = 0>
+  StatusCode push(const Time time, PolicyInType<_Idx> msg) {
+    std::get<_Idx>(queues_).push({time, std::move(msg)});
+    pending_.fetch_add(1);
+    if (drive_on_push_) {
+      poll();
+    }
+    return kMsgAccepted;
+  }
+
+  // match all queued messages, return immediately if another thread is
+  // matching, that thread will take over what is queued now
+  void poll() {
+    while (pending_.load() > 0) {
+      if (busy_.exchange(true)) {
+        return;
+      }
+      const size_t drained = drainHelper<kNumPolicies, true>();
+      busy_.store(false);
+
+      // a producer swapped in its node but has not linked it yet, give it
+      // the cpu instead of spinning on it
+      if (drained == 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // if false, pushes only enqueue and a matcher thread must call poll()
+  void setDriveOnPush(const bool drive) { drive_on_push_ = drive; }
+
+  // the wrapped syncronizer, only for setup or when no one pushes
+  Syncronizer &syncronizer() { return sync_; }
+
+  // messages rejected by the syncronizer, e.g. with non increasing stamp
+  size_t droppedCount() const { return dropped_.load(); }
+
+protected:
+  template <size_t _Idx>
+  using Queue = MpscQueue<std::pair<Time, PolicyInType<_Idx>>>;
+
+  template <typename _Seq> struct QueueTupleHelper;
+
+  template <size_t... _Is>
+  struct QueueTupleHelper<std::index_sequence<_Is...>> {
+    using type = std::tuple<Queue<_Is>...>;
+  };
+
+  using QueueTuple =
+      typename QueueTupleHelper<std::make_index_sequence<kNumPolicies>>::type;
+
+  // if _Idx != 0, drainHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>>
+  size_t drainHelper() {
+    size_t drained = 0;
+    std::pair<Time, PolicyInType<_Idx - 1>> item;
+    while (std::get<_Idx - 1>(queues_).pop(item)) {
+      pending_.fetch_sub(1);
+      ++drained;
+      if (kMsgDropped ==
+          sync_.template push<_Idx - 1>(item.first, std::move(item.second))) {
+        dropped_.fetch_add(1);
+      }
+    }
+    return drained + drainHelper<_Idx - 1, true>();
+  }
+
+  // if _Idx == 0, drainHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>>
+  size_t drainHelper() {
+    return 0;
+  }
+
+protected:
+  Syncronizer sync_;
+  QueueTuple queues_;
+  std::atomic<bool> drive_on_push_;
+  // counted after the node is queued, so the matching thread may pop it
+  // first and the count goes below zero for a moment, hence signed
+  std::atomic<std::ptrdiff_t> pending_;
+  std::atomic<size_t> dropped_;
+  std::atomic<bool> busy_;
+};
+
+} // namespace msync
@@ -1,13 +1,28 @@
 #pragma once
 
+#include <algorithm>
+#include <iterator>
 #include <limits>
+#include <list>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "stats.h"
 #include "storage.h"
 #include "traits.h"
 
 namespace msync {
 
+// interfaces a policy must supports, they are dispatched statically:
+//   bool push(const Time time, const InType &msg);
+//   bool push(const Time time, InType &&msg);
+//   Time sucTime(const Time time, const PolicyAttribute attr) const;
+//   std::pair<OutType, StatusCode> peek(const Time time) const;
+//   PolicyAttribute attr() const;
+//   Time maxLatency() const;
+//   bool releaseHeld(const Time now);
 template <typename _Derived> struct PolicyBase {
   using Derived = _Derived;
   using InType = typename PolicyTraits<Derived>::InType;
@@ -15,21 +30,18 @@ template <typename _Derived> struct PolicyBase {
 
   PolicyBase() {}
 
-  virtual bool push(const Time time, const InType &msg) = 0;
-
-  // get min successor of time
-  virtual Time sucTime(const Time time, const PolicyAttribute attr) const = 0;
-
-  // peek data given time
-  virtual std::pair<OutType, StatusCode> peek(const Time time) const = 0;
-
 protected:
-  Derived &derived() { return static_cast<Derived>(*this); }
-  const Derived &derived() const { return static_cast<Derived>(*this); }
+  Derived &derived() { return static_cast<Derived &>(*this); }
+  const Derived &derived() const { return static_cast<const Derived &>(*this); }
 };
 
 template <typename _Derived> struct Policy;
 
+template <typename _Alloc> struct IsStdAllocator : std::false_type {};
+
+template <typename _T>
+struct IsStdAllocator<std::allocator<_T>> : std::true_type {};
+
 template <typename _Derived> struct PolicyTraits<Policy<_Derived>> {
   using MsgType = typename PolicyTraits<_Derived>::MsgType;
   using InType = typename PolicyTraits<_Derived>::InType;
@@ -46,13 +58,45 @@ struct Policy : public PolicyBase<Policy<_Derived>> {
   using Storage = typename PolicyTraits<Derived>::Storage;
 
   Policy(const Time history_win, const PolicyAttribute attr = kNormal)
-      : storage_(history_win), attr_(attr) {}
+      : storage_(history_win), attr_(attr), reorder_win_(0), reordered_(0),
+        dropped_(0), overwritten_(0),
+        max_latency_(std::numeric_limits<Time>::max()) {}
+
+  // storage is made with alloc if it takes one, e.g. a PoolAllocator
+  template <typename _Alloc>
+  Policy(const Time history_win, const PolicyAttribute attr,
+         const _Alloc &alloc)
+      : storage_(makeStorage(history_win, alloc)), attr_(attr),
+        reorder_win_(0), reordered_(0), dropped_(0), overwritten_(0),
+        max_latency_(std::numeric_limits<Time>::max()) {}
+
+  bool push(const Time time, const InType &msg) { return insert(time, msg); }
+
+  bool push(const Time time, InType &&msg) {
+    return insert(time, std::move(msg));
+  }
 
-  bool push(const Time time, const InType &msg) override {
-    return storage_.push(time, msg);
+  // construct message in storage from args
+  template <typename... _Args> bool emplace(const Time time, _Args &&...args) {
+    if (reorder_win_ > 0) {
+      return insert(time, InType(std::forward<_Args>(args)...));
+    }
+    return counted(storage_.emplace(time, std::forward<_Args>(args)...));
   }
 
-  Time sucTime(const Time time, const PolicyAttribute attr) const override {
+  // messages are held back until the newest stamp is reorder_win past them,
+  // so the ones arriving late within that window are still put in order,
+  // and peek sees them only after that. set it before any push
+  void setReorderWin(const Time reorder_win) { reorder_win_ = reorder_win; }
+
+  // messages arrived older than a held back one, but were put in order
+  size_t reorderedCount() const { return reordered_; }
+
+  // messages rejected, being too late or with duplicated stamp, or dropped
+  // by a full storage of fixed capacity for newer ones
+  size_t droppedCount() const { return dropped_; }
+
+  Time sucTime(const Time time, const PolicyAttribute attr) const {
     auto iter = storage_.findSuc(time);
 
     if (attr_ < attr || iter == storage_.end()) {
@@ -62,26 +106,172 @@ struct Policy : public PolicyBase<Policy<_Derived>> {
     }
   }
 
-  std::pair<OutType, StatusCode> peek(const Time time) const override {
-    const auto &[msg, succeed] = doPeek(time);
-    if (succeed) {
-      return {{msg, true}, kPeekSuccess};
+  std::pair<OutType, StatusCode> peek(const Time time) const {
+    MSYNC_STATS(skew_ = std::numeric_limits<Time>::max();)
+    OutType out = derived().doPeek(time);
+    StatusCode status;
+    if (out.second) {
+      status = kPeekSuccess;
     } else if (!storage_.empty() && time < storage_.backStamp()) {
-      return {{msg, false}, kPeekExpired};
+      status = kPeekExpired;
     } else {
-      return {{msg, false}, kPeekNotReady};
+      status = kPeekNotReady;
     }
+    MSYNC_STATS(stats_.peeked(status);
+                if (kPeekSuccess == status &&
+                    skew_ != std::numeric_limits<Time>::max())
+                    stats_.skew(skew_);)
+    return {std::move(out), status};
   }
 
-  virtual OutType doPeek(const Time time) const = 0;
+  // peek at n times, outs[i] for times[i], out.second tells if it is a
+  // success, peek status and stats are skipped. derived policy may share
+  // work between times sorted NO DESCENDING by overriding doPeekBatch
+  void peekBatch(const Time *times, const size_t n, OutType *outs) const {
+    derived().doPeekBatch(times, n, outs);
+  }
+
+  // drop messages no peek LARGE(>) than time could use, the newest two
+  // messages NO LARGE(<=) than time are kept for interpolation and nearest.
+  // held messages NO LARGE(<=) than time are released first to be evicted
+  // alike, a late one older than them is dropped after
+  void evictBefore(const Time time) {
+    release(time);
+    auto pre = storage_.findPre(time);
+    if (pre != storage_.end() && pre != storage_.begin()) {
+      storage_.evictBefore(std::prev(pre)->first);
+    }
+  }
+
+  // release held messages reorder_win past now, on the clock given to
+  // syncronizer tick, so the tail of a stream going silent is not stuck.
+  // return true if any is released
+  bool releaseHeld(const Time now) {
+    if (held_.empty() ||
+        now < std::numeric_limits<Time>::lowest() + reorder_win_) {
+      return false;
+    }
+    return release(now - reorder_win_);
+  }
 
   PolicyAttribute attr() const { return attr_; }
 
-  size_t queueSize() const { return storage_.size(); }
+  // once the clock given to syncronizer tick is max_latency past a
+  // candidate this policy is not ready for, it is flagged if optional,
+  // or the candidate expires
+  void setMaxLatency(const Time max_latency) { max_latency_ = max_latency; }
+
+  Time maxLatency() const { return max_latency_; }
+
+  size_t queueSize() const { return storage_.size() + held_.size(); }
+
+  // storage of messages, e.g. to bind a SliceStorage to an arena
+  Storage &storage() { return storage_; }
+  const Storage &storage() const { return storage_; }
+
+  MSYNC_STATS(PolicyStatsSnapshot stats() const { return stats_.snapshot(); })
+
+protected:
+  // derived policy must implement OutType doPeek(const Time time) const
+  Derived &derived() { return static_cast<Derived &>(*this); }
+  const Derived &derived() const { return static_cast<const Derived &>(*this); }
+
+  // storage with alloc if it has such a constructor, e.g. MapStorage,
+  // otherwise alloc may only be a default std::allocator, which is unused
+  template <typename _Alloc>
+  static Storage makeStorage(const Time history_win, const _Alloc &alloc) {
+    if constexpr (std::is_constructible_v<Storage, Time, const _Alloc &>) {
+      return Storage(history_win, alloc);
+    } else {
+      static_assert(IsStdAllocator<_Alloc>::value,
+                    "storage takes no such allocator, it would be dropped");
+      return Storage(history_win);
+    }
+  }
+
+  // default batch peek, one doPeek per time
+  void doPeekBatch(const Time *times, const size_t n, OutType *outs) const {
+    for (size_t i = 0; i < n; ++i) {
+      outs[i] = derived().doPeek(times[i]);
+    }
+  }
+
+  bool counted(const bool accepted) {
+    dropped_ += !accepted;
+    MSYNC_STATS(stats_.pushed(accepted, queueSize());)
+    countOverwritten();
+    return accepted;
+  }
+
+  // a storage of fixed capacity drops its oldest message for a new one once
+  // full, such a message is dropped too
+  void countOverwritten() {
+    const size_t overwritten = storage_.overwrittenCount() - overwritten_;
+    if (overwritten > 0) {
+      overwritten_ += overwritten;
+      dropped_ += overwritten;
+      MSYNC_STATS(stats_.overwritten(overwritten);)
+    }
+  }
+
+  // derived doPeek tells the distance from peek time to the nearest stamp
+  // it looked at, kept in stats on success, none is kept if it tells not
+  void reportSkew([[maybe_unused]] const Time skew) const {
+    MSYNC_STATS(skew_ = skew;)
+  }
+
+  template <typename _Msg> bool insert(const Time time, _Msg &&msg) {
+    if (reorder_win_ <= 0) {
+      return counted(storage_.push(time, std::forward<_Msg>(msg)));
+    }
+
+    // too late, messages after it are already in storage
+    if (!storage_.empty() && time <= storage_.backStamp()) {
+      return counted(false);
+    }
+
+    // mostly in order, so search from back
+    auto iter = held_.end();
+    while (iter != held_.begin() && std::prev(iter)->first > time) {
+      --iter;
+    }
+    if (iter != held_.begin() && std::prev(iter)->first == time) {
+      return counted(false);
+    }
+    reordered_ += iter != held_.end();
+    held_.emplace(iter, time, std::forward<_Msg>(msg));
+
+    release(held_.back().first - reorder_win_);
+    return counted(true);
+  }
+
+  // move held messages NO LARGE(<=) than watermark to storage in stamp order
+  bool release(const Time watermark) {
+    bool released = false;
+    while (!held_.empty() && held_.front().first <= watermark) {
+      storage_.push(held_.front().first, std::move(held_.front().second));
+      held_.pop_front();
+      released = true;
+    }
+    countOverwritten();
+    return released;
+  }
 
 protected:
   Storage storage_;
   PolicyAttribute attr_;
+
+  Time reorder_win_;
+  // a list, unlike a deque, moves without throwing, so policies do
+  std::list<std::pair<Time, InType>> held_;
+  size_t reordered_;
+  size_t dropped_;
+  size_t overwritten_;
+
+  Time max_latency_;
+
+  // see stats.h, skew_ is set by reportSkew during a peek
+  MSYNC_STATS(mutable PolicyStats stats_; mutable Time skew_;)
 };
 
 template <typename _Policy> struct PolicyArray;
@@ -89,7 +279,7 @@ template <typename _Policy> struct PolicyArray;
 template <typename _Policy> struct PolicyTraits<PolicyArray<_Policy>> {
   using MsgType = typename PolicyTraits<_Policy>::MsgType;
   using InType = std::pair<MsgType, int>;
-  using OutType = std::vector<std::pair<MsgType, bool>>;
+  using OutType = std::vector<typename PolicyTraits<_Policy>::OutType>;
 };
 
 template <typename _Policy>
@@ -98,50 +288,163 @@ struct PolicyArray : public PolicyBase<PolicyArray<_Policy>> {
   using InType = typename PolicyTraits<PolicyArray>::InType;
   using OutType = typename PolicyTraits<PolicyArray>::OutType;
 
-  PolicyArray(const std::vector<Policy> &policies) : policies_(policies) {}
+  PolicyArray(const std::vector<Policy> &policies)
+      : policies_(policies), leaf_(1), query_valid_(false),
+        max_latency_(std::numeric_limits<Time>::max()) {
+    while (leaf_ < policies_.size()) {
+      leaf_ <<= 1;
+    }
+    tree_.assign(2 * leaf_, std::numeric_limits<Time>::max());
+  }
 
-  bool push(const Time time, const InType &msg) override {
-    return policies_.at(msg.second).push(time, msg.first);
+  bool push(const Time time, const InType &msg) {
+    return pushed(msg.second, policies_.at(msg.second).push(time, msg.first));
   }
 
-  Time sucTime(const Time time, const PolicyAttribute attr) const override {
-    Time suc = std::numeric_limits<Time>::max();
-    for (const auto &policy : policies_) {
-      suc = std::min(suc, policy.sucTime(time, attr));
+  bool push(const Time time, InType &&msg) {
+    const int id = msg.second;
+    return pushed(id, policies_.at(id).push(time, std::move(msg.first)));
+  }
+
+  // construct message in storage of policy id from args
+  template <typename... _Args>
+  bool emplace(const Time time, const int id, _Args &&...args) {
+    auto &policy = policies_.at(id);
+    return pushed(id, policy.emplace(time, std::forward<_Args>(args)...));
+  }
+
+  // successors of policies are kept in a tournament tree, query time could
+  // only move forward, so only the leaves passed by time need update
+  Time sucTime(const Time time, const PolicyAttribute attr) const {
+    if (!query_valid_ || attr != query_attr_ || time < query_time_) {
+      query_valid_ = true;
+      query_time_ = time;
+      query_attr_ = attr;
+      for (size_t i = 0; i < policies_.size(); ++i) {
+        updateLeaf(i);
+      }
+    } else {
+      query_time_ = time;
+      while (tree_[1] <= time) {
+        updateLeaf(minLeaf());
+      }
     }
-    return suc;
+    return tree_[1];
   }
 
-  std::pair<OutType, StatusCode> peek(const Time time) const override {
-    OutType total_out;
-    StatusCode total_status;
+  // peek into a buffer reused by every peek, so no allocation is made once
+  // it is sized, the returned out is valid until the next peek
+  std::pair<const OutType &, StatusCode> peek(const Time time) const {
+    out_.resize(policies_.size());
+
+    // required policies first, out is only kept while all of them succeed,
+    // and any expired one decides the status without peeking the rest
     bool all_success = true;
-    bool any_expire = false;
+    for (size_t i = 0; i < policies_.size(); ++i) {
+      if (policies_[i].attr() == kOptional)
+        continue;
 
-    for (const auto &policy : policies_) {
-      const auto &[out, status] = policy.peek(time);
-      total_out.emplace_back(out);
-      if (policy.attr() != kOptional) {
-        all_success &= (kPeekSuccess == status);
-        any_expire |= (kPeekExpired == status);
+      auto [out, status] = policies_[i].peek(time);
+      if (kPeekExpired == status) {
+        return {out_, kPeekExpired};
+      }
+
+      all_success &= (kPeekSuccess == status);
+      if (all_success) {
+        out_[i] = std::move(out);
       }
     }
 
-    if (all_success) {
-      total_status = kPeekSuccess;
-    } else if (any_expire) {
-      total_status = kPeekExpired;
-    } else {
-      total_status = kPeekNotReady;
+    if (!all_success) {
+      return {out_, kPeekNotReady};
+    }
+
+    // optional policies only when all required ones are ready
+    for (size_t i = 0; i < policies_.size(); ++i) {
+      if (policies_[i].attr() == kOptional) {
+        out_[i] = policies_[i].peek(time).first;
+      }
+    }
+
+    return {out_, kPeekSuccess};
+  }
+
+  void evictBefore(const Time time) {
+    for (auto &policy : policies_) {
+      policy.evictBefore(time);
     }
+  }
+
+  bool releaseHeld(const Time now) {
+    bool released = false;
+    for (size_t i = 0; i < policies_.size(); ++i) {
+      released |= pushed(i, policies_[i].releaseHeld(now));
+    }
+    return released;
+  }
 
-    return {total_out, total_status};
+  // optional only if all policies are
+  PolicyAttribute attr() const {
+    PolicyAttribute attr = kOptional;
+    for (const auto &policy : policies_) {
+      attr = std::max(attr, policy.attr());
+    }
+    return attr;
   }
 
+  // max latency of the array as a whole, see Policy::setMaxLatency
+  void setMaxLatency(const Time max_latency) { max_latency_ = max_latency; }
+
+  Time maxLatency() const { return max_latency_; }
+
   size_t queueSize(int id) const { return policies_.at(id).queueSize(); }
 
+  size_t reorderedCount(int id) const {
+    return policies_.at(id).reorderedCount();
+  }
+
+  size_t droppedCount(int id) const { return policies_.at(id).droppedCount(); }
+
+  MSYNC_STATS(PolicyStatsSnapshot stats(int id) const {
+    return policies_.at(id).stats();
+  })
+
+protected:
+  bool pushed(const size_t id, const bool accepted) {
+    if (accepted && query_valid_) {
+      updateLeaf(id);
+    }
+    return accepted;
+  }
+
+  void updateLeaf(const size_t id) const {
+    size_t node = leaf_ + id;
+    tree_[node] = policies_[id].sucTime(query_time_, query_attr_);
+    for (node >>= 1; node > 0; node >>= 1) {
+      tree_[node] = std::min(tree_[2 * node], tree_[2 * node + 1]);
+    }
+  }
+
+  size_t minLeaf() const {
+    size_t node = 1;
+    while (node < leaf_) {
+      node = tree_[2 * node] <= tree_[2 * node + 1] ? 2 * node : 2 * node + 1;
+    }
+    return node - leaf_;
+  }
+
 protected:
   std::vector<Policy> policies_;
+  mutable OutType out_;
+
+  // tournament tree of successors, tree_[1] is root, leaves start at leaf_
+  size_t leaf_;
+  mutable std::vector<Time> tree_;
+  mutable bool query_valid_;
+  mutable Time query_time_;
+  mutable PolicyAttribute query_attr_;
+
+  Time max_latency_;
 };
 
 } // namespace msync
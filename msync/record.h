@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "syncronizer.h"
+
+namespace msync {
+
+// Binary log of pushes into a syncronizer. The file starts with a header
+//   char magic[8] "MSYNCLOG", uint32 version, uint32 number of policies
+// followed by records appended in push order
+//   uint32 policy index, uint32 payload size, int64 stamp, payload
+// payload is written by SerializerTraits of the policy InType. Fields are
+// in host byte order.
+
+static constexpr char kLogMagic[8] = {'M', 'S', 'Y', 'N', 'C', 'L', 'O', 'G'};
+static constexpr uint32_t kLogVersion = 1;
+static constexpr size_t kLogHeaderSize = 16;
+static constexpr size_t kLogRecordHeaderSize = 16;
+
+struct LogRecord {
+  uint32_t index;
+  Time time;
+  const char *payload;
+  size_t size;
+};
+
+// append records to a log file through a buffered stream
+struct LogWriter {
+  LogWriter(const std::string &path, const uint32_t num_policies)
+      : file_(std::fopen(path.c_str(), "wb")), failed_(false) {
+    if (file_ == nullptr) {
+      return;
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    char header[kLogHeaderSize];
+    std::memcpy(header, kLogMagic, sizeof(kLogMagic));
+    std::memcpy(header + 8, &kLogVersion, sizeof(kLogVersion));
+    std::memcpy(header + 12, &num_policies, sizeof(num_policies));
+    write(header, sizeof(header));
+  }
+
+  LogWriter(const LogWriter &) = delete;
+  LogWriter &operator=(const LogWriter &) = delete;
+
+  ~LogWriter() {
+    if (file_ != nullptr) {
+      std::fclose(file_);
+    }
+  }
+
+  // a payload too large for the uint32 size of a record is not written,
+  // false is returned and ok() turns false, as the log misses a push
+  template <typename _Msg>
+  bool append(const uint32_t index, const Time time, const _Msg &msg) {
+    const size_t payload_size = SerializerTraits<_Msg>::size(msg);
+    if (payload_size > UINT32_MAX) {
+      failed_ = true;
+      return false;
+    }
+    const uint32_t size = payload_size;
+    buffer_.resize(kLogRecordHeaderSize + size);
+    std::memcpy(buffer_.data(), &index, sizeof(index));
+    std::memcpy(buffer_.data() + 4, &size, sizeof(size));
+    std::memcpy(buffer_.data() + 8, &time, sizeof(time));
+    SerializerTraits<_Msg>::serialize(msg,
+                                      buffer_.data() + kLogRecordHeaderSize);
+    write(buffer_.data(), buffer_.size());
+    return true;
+  }
+
+  void flush() {
+    if (file_ != nullptr) {
+      std::fflush(file_);
+    }
+  }
+
+  // false if file could not be opened or a write failed
+  bool ok() const { return file_ != nullptr && !failed_; }
+
+protected:
+  void write(const char *data, const size_t size) {
+    if (file_ != nullptr && std::fwrite(data, 1, size, file_) != size) {
+      failed_ = true;
+    }
+  }
+
+protected:
+  std::FILE *file_;
+  bool failed_;
+  std::vector<char> buffer_;
+};
+
+// read records of a log file in order, the file is streamed through a
+// buffer of one window, so memory used does not grow with the file size
+struct LogReader {
+  LogReader(const std::string &path, const size_t window = 64 << 20)
+      : file_(std::fopen(path.c_str(), "rb")), window_(std::max<size_t>(
+                                                   window, 4096)),
+        offset_(0), num_policies_(0), file_size_(0), truncated_(false),
+        buffer_offset_(0), buffer_size_(0) {
+    if (file_ == nullptr) {
+      return;
+    }
+    if (std::fseek(file_, 0, SEEK_END) == 0) {
+      file_size_ = std::max<long>(std::ftell(file_), 0);
+    }
+    std::rewind(file_);
+    buffer_.resize(window_);
+
+    const char *header = view(0, kLogHeaderSize);
+    uint32_t version = 0;
+    if (header == nullptr ||
+        std::memcmp(header, kLogMagic, sizeof(kLogMagic)) != 0) {
+      return;
+    }
+    std::memcpy(&version, header + 8, sizeof(version));
+    std::memcpy(&num_policies_, header + 12, sizeof(num_policies_));
+    if (version == kLogVersion) {
+      offset_ = kLogHeaderSize;
+    }
+  }
+
+  LogReader(const LogReader &) = delete;
+  LogReader &operator=(const LogReader &) = delete;
+
+  ~LogReader() {
+    if (file_ != nullptr) {
+      std::fclose(file_);
+    }
+  }
+
+  // false if file could not be opened or is not a log
+  bool ok() const { return offset_ > 0; }
+
+  uint32_t numPolicies() const { return num_policies_; }
+
+  // true if the log ends within a record, e.g. a write cut short or a
+  // corrupt size
+  bool truncated() const { return truncated_; }
+
+  // read the next record, its payload is valid until the next call, false
+  // at the end of log or on a truncated record
+  bool next(LogRecord &record) {
+    if (!ok()) {
+      return false;
+    }
+    const char *header = view(offset_, kLogRecordHeaderSize);
+    if (header == nullptr) {
+      truncated_ = offset_ < file_size_;
+      return false;
+    }
+    uint32_t size;
+    std::memcpy(&record.index, header, sizeof(record.index));
+    std::memcpy(&size, header + 4, sizeof(size));
+    std::memcpy(&record.time, header + 8, sizeof(record.time));
+
+    // size is checked against the file before the buffer is grown for it,
+    // so a corrupt one can not make a huge allocation
+    if (size > file_size_ - offset_ - kLogRecordHeaderSize) {
+      truncated_ = true;
+      return false;
+    }
+    const char *data = view(offset_, kLogRecordHeaderSize + size);
+    if (data == nullptr) {
+      truncated_ = true;
+      return false;
+    }
+    record.payload = data + kLogRecordHeaderSize;
+    record.size = size;
+    offset_ += kLogRecordHeaderSize + size;
+    return true;
+  }
+
+protected:
+  // pointer to [offset, offset + size) of file, offset never goes back.
+  // if it is not all buffered, the buffered rest is moved to the front
+  // and the buffer is refilled after it
+  const char *view(const uint64_t offset, const size_t size) {
+    if (offset + size > buffer_offset_ + buffer_size_) {
+      const size_t keep = buffer_offset_ + buffer_size_ - offset;
+      std::memmove(buffer_.data(), buffer_.data() + (offset - buffer_offset_),
+                   keep);
+      if (buffer_.size() < size) {
+        buffer_.resize(size);
+      }
+      buffer_offset_ = offset;
+      buffer_size_ = keep + std::fread(buffer_.data() + keep, 1,
+                                       buffer_.size() - keep, file_);
+      if (buffer_size_ < size) {
+        return nullptr;
+      }
+    }
+    return buffer_.data() + (offset - buffer_offset_);
+  }
+
+protected:
+  std::FILE *file_;
+  size_t window_;
+  uint64_t offset_;
+  uint32_t num_policies_;
+  uint64_t file_size_;
+  bool truncated_;
+
+  std::vector<char> buffer_;
+  uint64_t buffer_offset_;
+  size_t buffer_size_;
+};
+
+// Record every push into a syncronizer, push through the recorder instead
+// of the syncronizer itself. Pushes made on the syncronizer directly are not
+// recorded, nor is emplace wrapped, a message has to be built to be written
+// anyway, so build it and push it here.
+template <typename _Sync> struct SyncRecorder {
+  using Syncronizer = _Sync;
+
+  static constexpr size_t kNumPolicies = Syncronizer::kNumPolicies;
+
+  template <size_t _Idx>
+  using PolicyInType = typename Syncronizer::template PolicyInType<_Idx>;
+
+  SyncRecorder(Syncronizer &sync, const std::string &path)
+      : sync_(sync), writer_(path, kNumPolicies) {}
+
+  template <size_t _Idx = 0>
+  StatusCode push(const Time time, const PolicyInType<_Idx> &msg) {
+    writer_.append(_Idx, time, msg);
+    return sync_.template push<_Idx>(time, msg);
+  }
+
+  template <size_t _Idx = 0>
+  StatusCode push(const Time time, PolicyInType<_Idx> &&msg) {
+    writer_.append(_Idx, time, msg);
+    return sync_.template push<_Idx>(time, std::move(msg));
+  }
+
+  void flush() { writer_.flush(); }
+
+  bool ok() const { return writer_.ok(); }
+
+protected:
+  Syncronizer &sync_;
+  LogWriter writer_;
+};
+
+// Push records of a log into a syncronizer in order, as fast as it takes.
+template <typename _Sync> struct SyncReplayer {
+  using Syncronizer = _Sync;
+
+  static constexpr size_t kNumPolicies = Syncronizer::kNumPolicies;
+
+  template <size_t _Idx>
+  using PolicyInType = typename Syncronizer::template PolicyInType<_Idx>;
+
+  SyncReplayer(Syncronizer &sync, const std::string &path,
+               const size_t window = 64 << 20)
+      : sync_(sync), reader_(path, window), malformed_(0) {}
+
+  // false if log could not be read or was recorded with other policies
+  bool ok() const {
+    return reader_.ok() && reader_.numPolicies() == kNumPolicies;
+  }
+
+  // push the next record, false at the end of log
+  bool step() {
+    LogRecord record;
+    if (!ok() || !reader_.next(record)) {
+      return false;
+    }
+    if (!pushHelper<kNumPolicies, true>(record)) {
+      ++malformed_;
+    }
+    return true;
+  }
+
+  // push all remaining records, return how many there were
+  size_t replay() {
+    size_t count = 0;
+    while (step()) {
+      ++count;
+    }
+    return count;
+  }
+
+  // records with unknown policy index or undecodable payload
+  size_t malformedCount() const { return malformed_; }
+
+  // true if replay stopped within a record, see LogReader::truncated
+  bool truncated() const { return reader_.truncated(); }
+
+protected:
+  // if _Idx != 0, pushHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>>
+  bool pushHelper(const LogRecord &record) {
+    if (record.index != _Idx - 1) {
+      return pushHelper<_Idx - 1, true>(record);
+    }
+    PolicyInType<_Idx - 1> msg;
+    if (!SerializerTraits<PolicyInType<_Idx - 1>>::deserialize(
+            record.payload, record.size, msg)) {
+      return false;
+    }
+    sync_.template push<_Idx - 1>(record.time, std::move(msg));
+    return true;
+  }
+
+  // if _Idx == 0, pushHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>>
+  bool pushHelper(const LogRecord &) {
+    return false;
+  }
+
+protected:
+  Syncronizer &sync_;
+  LogReader reader_;
+  size_t malformed_;
+};
+
+} // namespace msync
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include "types.h"
+
+// Runtime statistics, compiled in only if MSYNC_ENABLE_STATS is defined,
+// otherwise code wrapped by MSYNC_STATS, stats members included, vanishes
+// and nothing is measured. Policies and syncronizers differ with and without
+// it, so every translation unit of a program must agree on the switch.
+#ifdef MSYNC_ENABLE_STATS
+#define MSYNC_STATS(...) __VA_ARGS__
+#else
+#define MSYNC_STATS(...)
+#endif
+
+namespace msync {
+
+// counter written by one thread at a time, read by any thread
+struct StatCounter {
+  StatCounter() : value_(0) {}
+
+  StatCounter(const StatCounter &other) noexcept : value_(other.load()) {}
+
+  StatCounter &operator=(const StatCounter &other) noexcept {
+    value_.store(other.load(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  void add(const uint64_t n = 1) {
+    value_.store(value_.load(std::memory_order_relaxed) + n,
+                 std::memory_order_relaxed);
+  }
+
+  void max(const uint64_t n) {
+    if (n > value_.load(std::memory_order_relaxed)) {
+      value_.store(n, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t load() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint64_t> value_;
+};
+
+struct HistogramSnapshot {
+  // bucket 0 counts 0, bucket i counts [2^(i-1), 2^i)
+  std::array<uint64_t, 65> buckets;
+  uint64_t count;
+  uint64_t sum;
+
+  // upper bound of the bucket where q (0~1) of values fall below
+  uint64_t percentile(const double q) const {
+    const double target = q * count;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      seen += buckets[i];
+      if (seen > 0 && seen >= target) {
+        return i == 0 ? 0 : i == 64 ? UINT64_MAX : (uint64_t(1) << i) - 1;
+      }
+    }
+    return 0;
+  }
+
+  double mean() const { return count > 0 ? double(sum) / count : 0.0; }
+};
+
+// histogram with power of two buckets, written by one thread at a time
+struct Log2Histogram {
+  void add(const uint64_t value) {
+    buckets_[value == 0 ? 0 : 64 - __builtin_clzll(value)].add();
+    count_.add();
+    sum_.add(value);
+  }
+
+  HistogramSnapshot snapshot() const {
+    HistogramSnapshot snap;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+      snap.buckets[i] = buckets_[i].load();
+    }
+    snap.count = count_.load();
+    snap.sum = sum_.load();
+    return snap;
+  }
+
+private:
+  std::array<StatCounter, 65> buckets_;
+  StatCounter count_;
+  StatCounter sum_;
+};
+
+struct PolicyStatsSnapshot {
+  uint64_t accepted;
+  uint64_t dropped; // rejected, or overwritten by a full storage later
+  uint64_t peek_success;
+  uint64_t peek_not_ready;
+  uint64_t peek_expired;
+  uint64_t high_water; // most messages held at once
+
+  // distance from successful peek time to the nearest stamp held, for a
+  // slave of master slave syncronizer it is skew to the master stamp
+  HistogramSnapshot skew;
+};
+
+struct PolicyStats {
+  void pushed(const bool accepted, const size_t occupancy) {
+    if (accepted) {
+      accepted_.add();
+      high_water_.max(occupancy);
+    } else {
+      dropped_.add();
+    }
+  }
+
+  // dropped by a full storage for newer ones, after being accepted
+  void overwritten(const uint64_t n) { dropped_.add(n); }
+
+  void peeked(const StatusCode status) {
+    if (kPeekSuccess == status) {
+      peek_success_.add();
+    } else if (kPeekExpired == status) {
+      peek_expired_.add();
+    } else {
+      peek_not_ready_.add();
+    }
+  }
+
+  void skew(const Time skew) { skew_.add(uint64_t(skew)); }
+
+  PolicyStatsSnapshot snapshot() const {
+    return {accepted_.load(),       dropped_.load(),
+            peek_success_.load(),   peek_not_ready_.load(),
+            peek_expired_.load(),   high_water_.load(),
+            skew_.snapshot()};
+  }
+
+private:
+  StatCounter accepted_;
+  StatCounter dropped_;
+  StatCounter peek_success_;
+  StatCounter peek_not_ready_;
+  StatCounter peek_expired_;
+  StatCounter high_water_;
+  Log2Histogram skew_;
+};
+
+struct SyncronizerStatsSnapshot {
+  uint64_t accepted;
+  uint64_t dropped;
+  uint64_t emitted;
+  uint64_t expired;
+  uint64_t not_ready;
+
+  // wall clock nanoseconds from the first try of a candidate to its
+  // emission, i.e. how long it waited for the other policies
+  HistogramSnapshot candidate_latency;
+
+  // wall clock nanoseconds spent in callback
+  HistogramSnapshot callback;
+};
+
+struct SyncronizerStats {
+  using Clock = std::chrono::steady_clock;
+
+  SyncronizerStats() : candidate_(std::numeric_limits<Time>::lowest()) {}
+
+  static uint64_t nanos(const Clock::time_point from,
+                        const Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from)
+        .count();
+  }
+
+  void pushed(const bool accepted) {
+    (accepted ? accepted_ : dropped_).add();
+  }
+
+  // a match is tried on candidate time
+  void tried(const Time time, const StatusCode status) {
+    const auto now = Clock::now();
+    if (time != candidate_) {
+      candidate_ = time;
+      since_ = now;
+    }
+    if (kEmitSuccess == status) {
+      emitted_.add();
+      candidate_latency_.add(nanos(since_, now));
+    } else if (kEmitExpired == status) {
+      expired_.add();
+    } else {
+      not_ready_.add();
+    }
+  }
+
+  void called(const Clock::time_point from) {
+    callback_.add(nanos(from, Clock::now()));
+  }
+
+  SyncronizerStatsSnapshot snapshot() const {
+    return {accepted_.load(),
+            dropped_.load(),
+            emitted_.load(),
+            expired_.load(),
+            not_ready_.load(),
+            candidate_latency_.snapshot(),
+            callback_.snapshot()};
+  }
+
+private:
+  StatCounter accepted_;
+  StatCounter dropped_;
+  StatCounter emitted_;
+  StatCounter expired_;
+  StatCounter not_ready_;
+  Log2Histogram candidate_latency_;
+  Log2Histogram callback_;
+
+  // candidate last tried and when it was first tried
+  Time candidate_;
+  Clock::time_point since_;
+};
+
+} // namespace msync
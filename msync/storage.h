@@ -1,6 +1,8 @@
 #pragma once
 
+#include <limits>
 #include <map>
+#include <utility>
 
 #include "traits.h"
 #include "types.h"
@@ -21,6 +23,19 @@ template <typename _Derived> struct StorageBase {
     return derived().pushImpl(time, msg);
   }
 
+  // append a message at tail, msg is moved in, untouched if rejected
+  bool push(const Time time, MsgType &&msg) {
+    return derived().pushImpl(time, std::move(msg));
+  }
+
+  // append a message constructed in place from args at tail
+  template <typename... _Args> bool emplace(const Time time, _Args &&...args) {
+    return derived().emplaceImpl(time, std::forward<_Args>(args)...);
+  }
+
+  // remove all items with stamp SMALL(<) than time
+  void evictBefore(const Time time) { derived().evictBeforeImpl(time); }
+
   // how many message current in storage
   size_t size() const { return derived().sizeImpl(); }
 
@@ -60,10 +75,24 @@ template <typename _Derived> struct StorageBase {
   // the back (largest) stamp
   Time backStamp() const { return derived().backStampImpl(); }
 
+  // items dropped for newer ones while full, by a storage of fixed capacity,
+  // a storage growing as needed drops none
+  size_t overwrittenCount() const { return derived().overwrittenCountImpl(); }
+
+  // a push at time evicts items with stamp SMALL(<) than windowStart(time),
+  // time - history window, saturated so a window of max keeps everything
+  Time windowStart(const Time time) const {
+    return time < std::numeric_limits<Time>::lowest() + history_win_
+               ? std::numeric_limits<Time>::lowest()
+               : time - history_win_;
+  }
+
 protected:
   Derived &derived() { return static_cast<Derived &>(*this); }
   const Derived &derived() const { return static_cast<const Derived &>(*this); }
 
+  size_t overwrittenCountImpl() const { return 0; }
+
   Time history_win_;
 };
 
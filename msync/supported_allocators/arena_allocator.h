@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace msync {
+
+// Arena for bounded runs such as replay of a log. Allocations are carved
+// from blocks one after another and deallocation does nothing, memory is
+// given back only when the arena is gone. The first block is made up
+// front, so a run of known size costs one allocation. Not thread safe.
+struct MonotonicArena {
+  explicit MonotonicArena(const size_t block_size)
+      : block_size_(block_size > 0 ? block_size : 1), cursor_(nullptr),
+        left_(0), used_(0) {
+    grow(block_size_);
+  }
+
+  MonotonicArena(const MonotonicArena &) = delete;
+  MonotonicArena &operator=(const MonotonicArena &) = delete;
+
+  ~MonotonicArena() {
+    for (void *block : blocks_) {
+      ::operator delete(block);
+    }
+  }
+
+  void *allocate(const size_t size, const size_t align) {
+    size_t pad = (align - uintptr_t(cursor_) % align) % align;
+    if (pad + size > left_) {
+      // a request larger than block size gets a block of its own
+      grow(std::max(block_size_, size + align));
+      pad = (align - uintptr_t(cursor_) % align) % align;
+    }
+    char *p = cursor_ + pad;
+    cursor_ += pad + size;
+    left_ -= pad + size;
+    used_ += size;
+    return p;
+  }
+
+  void deallocate(void *, const size_t) {}
+
+  // blocks made so far, each is one allocation
+  size_t blockCount() const { return blocks_.size(); }
+
+  // bytes handed out so far, never decreases
+  size_t bytesUsed() const { return used_; }
+
+protected:
+  void grow(const size_t size) {
+    cursor_ = static_cast<char *>(::operator new(size));
+    blocks_.push_back(cursor_);
+    left_ = size;
+  }
+
+protected:
+  size_t block_size_;
+  char *cursor_;
+  size_t left_;
+  size_t used_;
+  std::vector<void *> blocks_;
+};
+
+// Stateful allocator over a shared MonotonicArena, copies and rebinds use
+// the same arena. Pass it to policy constructors as PoolAllocator.
+template <typename _T> struct ArenaAllocator {
+  using value_type = _T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  explicit ArenaAllocator(const size_t block_size)
+      : arena_(std::make_shared<MonotonicArena>(block_size)) {}
+
+  explicit ArenaAllocator(std::shared_ptr<MonotonicArena> arena)
+      : arena_(std::move(arena)) {}
+
+  template <typename _U>
+  ArenaAllocator(const ArenaAllocator<_U> &other) : arena_(other.arena()) {}
+
+  _T *allocate(const size_t n) {
+    return static_cast<_T *>(arena_->allocate(sizeof(_T) * n, alignof(_T)));
+  }
+
+  void deallocate(_T *p, const size_t n) {
+    arena_->deallocate(p, sizeof(_T) * n);
+  }
+
+  const std::shared_ptr<MonotonicArena> &arena() const { return arena_; }
+
+protected:
+  std::shared_ptr<MonotonicArena> arena_;
+};
+
+template <typename _T, typename _U>
+bool operator==(const ArenaAllocator<_T> &a, const ArenaAllocator<_U> &b) {
+  return a.arena() == b.arena();
+}
+
+template <typename _T, typename _U>
+bool operator!=(const ArenaAllocator<_T> &a, const ArenaAllocator<_U> &b) {
+  return !(a == b);
+}
+
+} // namespace msync
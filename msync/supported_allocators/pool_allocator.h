@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../types.h"
+
+namespace msync {
+
+// Pool of fixed size nodes for node based storages, e.g. MapStorage. Nodes
+// are carved from chunks of capacity nodes, a freed node goes to a free list
+// and is handed out again, so once the first chunk is made nothing is
+// allocated while no more than capacity nodes are in use. Single object
+// allocations are pooled by size, a free list and chunks for each, so the
+// map nodes of a storage are pooled even if a vector of it allocates a
+// single stamp first. Arrays go to operator new and are counted as
+// fallbacks. Over-aligned nodes get chunks of their alignment. Not thread
+// safe, a pool serves storages pushed by one thread.
+struct NodePool {
+  explicit NodePool(const size_t capacity)
+      : capacity_(capacity > 0 ? capacity : 1), last_(0), in_use_(0),
+        high_water_(0), fallbacks_(0) {}
+
+  NodePool(const NodePool &) = delete;
+  NodePool &operator=(const NodePool &) = delete;
+
+  ~NodePool() {
+    for (const auto &chunk : chunks_) {
+      release(chunk.first, chunk.second);
+    }
+  }
+
+  // nodes held by num_storages storages with history_win, pushed every
+  // period, one more each for the push made before eviction and for jitter
+  static size_t capacityFor(const Time history_win, const Time period,
+                            const size_t num_storages = 1) {
+    const size_t per_storage = period > 0 ? size_t(history_win / period) : 0;
+    return (per_storage + 3) * num_storages;
+  }
+
+  void *allocate(const size_t size, const size_t align, const size_t n) {
+    if (n != 1) {
+      ++fallbacks_;
+      return acquire(size * n, align);
+    }
+    SizeClass &cls = sizeClass(size, align);
+    if (cls.free == nullptr) {
+      refill(cls);
+    }
+    Node *node = cls.free;
+    cls.free = node->next;
+    if (++in_use_ > high_water_) {
+      high_water_ = in_use_;
+    }
+    return node;
+  }
+
+  void deallocate(void *p, const size_t size, const size_t align,
+                  const size_t n) {
+    if (n != 1) {
+      release(p, align);
+      return;
+    }
+    SizeClass &cls = sizeClass(size, align);
+    Node *node = static_cast<Node *>(p);
+    node->next = cls.free;
+    cls.free = node;
+    --in_use_;
+  }
+
+  size_t capacity() const { return capacity_; }
+
+  // chunks made so far, each is one allocation of capacity nodes
+  size_t chunkCount() const { return chunks_.size(); }
+
+  // allocations not served by the pool
+  size_t fallbackCount() const { return fallbacks_; }
+
+  size_t nodesInUse() const { return in_use_; }
+
+  // most nodes in use at once
+  size_t highWater() const { return high_water_; }
+
+protected:
+  struct Node {
+    Node *next;
+  };
+
+  // nodes of one stride and alignment
+  struct SizeClass {
+    size_t stride;
+    size_t align;
+    Node *free;
+  };
+
+  static size_t alignOf(const size_t align) {
+    return align > alignof(Node) ? align : alignof(Node);
+  }
+
+  static size_t strideOf(const size_t size, const size_t align) {
+    const size_t a = alignOf(align);
+    const size_t s = size > sizeof(Node) ? size : sizeof(Node);
+    return (s + a - 1) / a * a;
+  }
+
+  // operator new and delete of alignment align
+  static void *acquire(const size_t size, const size_t align) {
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return ::operator new(size, std::align_val_t(align));
+    }
+    return ::operator new(size);
+  }
+
+  static void release(void *p, const size_t align) {
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(p, std::align_val_t(align));
+    } else {
+      ::operator delete(p);
+    }
+  }
+
+  // a storage allocates one or two sizes, the last one used is tried first
+  SizeClass &sizeClass(const size_t size, const size_t align) {
+    const size_t stride = strideOf(size, align);
+    const size_t a = alignOf(align);
+    if (last_ < classes_.size() && classes_[last_].stride == stride &&
+        classes_[last_].align == a) {
+      return classes_[last_];
+    }
+    for (last_ = 0; last_ < classes_.size(); ++last_) {
+      if (classes_[last_].stride == stride && classes_[last_].align == a) {
+        return classes_[last_];
+      }
+    }
+    classes_.push_back({stride, a, nullptr});
+    return classes_.back();
+  }
+
+  // make a chunk of capacity nodes and put them on the free list
+  void refill(SizeClass &cls) {
+    char *chunk =
+        static_cast<char *>(acquire(cls.stride * capacity_, cls.align));
+    chunks_.emplace_back(chunk, cls.align);
+    for (size_t i = capacity_; i > 0; --i) {
+      Node *node = reinterpret_cast<Node *>(chunk + (i - 1) * cls.stride);
+      node->next = cls.free;
+      cls.free = node;
+    }
+  }
+
+protected:
+  size_t capacity_;
+  std::vector<SizeClass> classes_;
+  size_t last_;
+  // each chunk with its alignment
+  std::vector<std::pair<void *, size_t>> chunks_;
+
+  size_t in_use_;
+  size_t high_water_;
+  size_t fallbacks_;
+};
+
+// Stateful allocator over a shared NodePool, copies and rebinds use the same
+// pool, so a storage copied from another shares its pool. Pass it to policy
+// constructors, e.g.
+//   using Alloc = PoolAllocator<std::pair<const Time, Msg>>;
+//   Alloc alloc(NodePool::capacityFor(history_win, period));
+//   NearestPolicy<Msg, Alloc> policy(history_win, valid_win, kNormal, alloc);
+template <typename _T> struct PoolAllocator {
+  using value_type = _T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  explicit PoolAllocator(const size_t capacity)
+      : pool_(std::make_shared<NodePool>(capacity)) {}
+
+  explicit PoolAllocator(std::shared_ptr<NodePool> pool)
+      : pool_(std::move(pool)) {}
+
+  template <typename _U>
+  PoolAllocator(const PoolAllocator<_U> &other) : pool_(other.pool()) {}
+
+  _T *allocate(const size_t n) {
+    return static_cast<_T *>(pool_->allocate(sizeof(_T), alignof(_T), n));
+  }
+
+  void deallocate(_T *p, const size_t n) {
+    pool_->deallocate(p, sizeof(_T), alignof(_T), n);
+  }
+
+  const std::shared_ptr<NodePool> &pool() const { return pool_; }
+
+protected:
+  std::shared_ptr<NodePool> pool_;
+};
+
+template <typename _T, typename _U>
+bool operator==(const PoolAllocator<_T> &a, const PoolAllocator<_U> &b) {
+  return a.pool() == b.pool();
+}
+
+template <typename _T, typename _U>
+bool operator!=(const PoolAllocator<_T> &a, const PoolAllocator<_U> &b) {
+  return !(a == b);
+}
+
+} // namespace msync
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+
 #include "../traits.h"
 
 // NOTE: user may have eigen install in different location
@@ -22,14 +25,16 @@ struct LinearInterpolaterTraits<Eigen::Quaternion<Scalar>> {
 
   static T Exp(const Tangent &tangent) {
     const Scalar theta = tangent.norm();
-    auto normalized_tangent = tangent.normalized();
-    Scalar sin_theta = sin(theta / 2.0);
-    Scalar cos_theta = cos(theta / 2.0);
+    // sin(theta / 2) / theta, by its taylor series near 0, so a tangent
+    // whose squared norm underflows still keeps its vector part
+    const Scalar half_sinc = theta < Scalar(1e-4)
+                                 ? Scalar(0.5) - theta * theta / Scalar(48.0)
+                                 : Scalar(sin(theta / 2.0)) / theta;
     T q;
-    q.x() = normalized_tangent(0) * sin_theta;
-    q.y() = normalized_tangent(1) * sin_theta;
-    q.z() = normalized_tangent(2) * sin_theta;
-    q.w() = cos_theta;
+    q.x() = tangent(0) * half_sinc;
+    q.y() = tangent(1) * half_sinc;
+    q.z() = tangent(2) * half_sinc;
+    q.w() = cos(theta / 2.0);
     return q;
   }
 
@@ -79,4 +84,144 @@ struct LinearInterpolaterTraits<Eigen::Quaternion<Scalar>> {
   }
 };
 
+// eigen quaternion batch interpolater traits. from * Exp(tangent * r) is
+// from * [cos(h), tangent * sin(h) / theta] with h = theta * r / 2, so it is
+// from * cos(h) + k * sin(h) / theta with k = from * [0, tangent] fixed for
+// the segment. each ratio costs a scalar sin and cos and 8 multiply adds,
+// no Log or Exp
+template <typename Scalar>
+struct BatchInterpolaterTraits<
+    Eigen::Quaternion<Scalar>,
+    LinearInterpolaterTraits<Eigen::Quaternion<Scalar>>> {
+  using T = Eigen::Quaternion<Scalar>;
+  using Tangent = Eigen::Matrix<Scalar, 3, 1>;
+
+  static constexpr size_t kChunk = 64;
+
+  static void plus(const T &from, const Tangent &tangent,
+                   const double *ratios, const size_t n, T *out) {
+    const T k = from * T(0, tangent.x(), tangent.y(), tangent.z());
+    const Scalar theta = tangent.norm();
+    Scalar cs[kChunk];
+    Scalar ss[kChunk];
+    for (size_t first = 0; first < n; first += kChunk) {
+      const size_t m = std::min(kChunk, n - first);
+      halfAngles(theta, ratios + first, m, cs, ss);
+      for (size_t i = 0; i < m; ++i) {
+        out[first + i].coeffs() = from.coeffs() * cs[i] + k.coeffs() * ss[i];
+      }
+    }
+  }
+
+  // cos(h) and sin(h) / theta of h = theta * r / 2, by limit if theta is 0
+  static void halfAngles(const Scalar theta, const double *ratios,
+                         const size_t n, Scalar *cs, Scalar *ss) {
+    if (theta < Scalar(1e-10)) {
+      for (size_t i = 0; i < n; ++i) {
+        cs[i] = Scalar(1.0);
+        ss[i] = Scalar(0.5 * ratios[i]);
+      }
+      return;
+    }
+    const Scalar inv_theta = Scalar(1.0) / theta;
+    for (size_t i = 0; i < n; ++i) {
+      const Scalar h = Scalar(0.5 * ratios[i]) * theta;
+      cs[i] = cos(h);
+      ss[i] = sin(h) * inv_theta;
+    }
+  }
+};
+
+// eigen quaternion fast interpolater traits, slerp without Log and Exp.
+// tangent keeps the segment end and cos of the angle between ends, theta,
+// scaling it scales the ratio r. plus is
+//   from * sin((1 - r) theta) / sin(theta) + to * sin(r theta) / sin(theta)
+// with both weights by a polynomial in cos(theta) (Eberly, "A fast and
+// accurate algorithm for computing slerp"), no transcendental at all. for
+// rotations up to 1 rad between ends the weights are within 2e-12 of
+// exact, larger rotations fall back to exact weights by sin
+template <typename Scalar>
+struct FastInterpolaterTraits<Eigen::Quaternion<Scalar>> {
+  using T = Eigen::Quaternion<Scalar>;
+
+  struct Tangent {
+    Tangent operator*(const double ratio) const {
+      return {to, cos_theta, Scalar(this->ratio * ratio)};
+    }
+
+    T to;
+    Scalar cos_theta;
+    Scalar ratio;
+  };
+
+  static constexpr int kTerms = 8;
+
+  static T plus(const T &from, const Tangent &tangent) {
+    Scalar w_from, w_to;
+    weights(tangent.cos_theta, tangent.ratio, w_from, w_to);
+    T q;
+    q.coeffs() = from.coeffs() * w_from + tangent.to.coeffs() * w_to;
+    return q;
+  }
+
+  // to is flipped to the same hemisphere as from, for the shorter path
+  static Tangent between(const T &from, const T &to) {
+    const Scalar cos_theta = from.dot(to);
+    if (cos_theta < Scalar(0.0)) {
+      return {T(-to.coeffs()), -cos_theta, Scalar(1.0)};
+    }
+    return {to, cos_theta, Scalar(1.0)};
+  }
+
+  // sin((1 - r) theta) / sin(theta) and sin(r theta) / sin(theta)
+  static void weights(const Scalar cos_theta, const Scalar r, Scalar &w_from,
+                      Scalar &w_to) {
+    // cos(0.5), half angle of 1 rad rotation
+    if (cos_theta >= Scalar(0.8775825618903728)) {
+      w_from = weight(cos_theta, Scalar(1.0) - r);
+      w_to = weight(cos_theta, r);
+      return;
+    }
+    const Scalar theta = acos(cos_theta);
+    const Scalar inv_sin = Scalar(1.0) / sin(theta);
+    w_from = sin((Scalar(1.0) - r) * theta) * inv_sin;
+    w_to = sin(r * theta) * inv_sin;
+  }
+
+  // sin(r theta) / sin(theta) = r * prod(1 + (u_i r^2 - v_i)(cos - 1)),
+  // nested, with u_i = 1 / (i (2i + 1)), v_i = i / (2i + 1)
+  static Scalar weight(const Scalar cos_theta, const Scalar r) {
+    static constexpr double u[kTerms] = {1.0 / 3,  1.0 / 10, 1.0 / 21,
+                                         1.0 / 36, 1.0 / 55, 1.0 / 78,
+                                         1.0 / 105, 1.0 / 136};
+    static constexpr double v[kTerms] = {1.0 / 3,  2.0 / 5,  3.0 / 7,
+                                         4.0 / 9,  5.0 / 11, 6.0 / 13,
+                                         7.0 / 15, 8.0 / 17};
+    const Scalar xm1 = cos_theta - Scalar(1.0);
+    const Scalar r2 = r * r;
+    Scalar acc = Scalar(1.0);
+    for (int i = kTerms - 1; i >= 0; --i) {
+      acc = Scalar(1.0) + (Scalar(u[i]) * r2 - Scalar(v[i])) * xm1 * acc;
+    }
+    return r * acc;
+  }
+};
+
+// eigen quaternion serializer traits, coeffs in [x,y,z,w] order
+template <typename Scalar> struct SerializerTraits<Eigen::Quaternion<Scalar>> {
+  using T = Eigen::Quaternion<Scalar>;
+
+  static size_t size(const T &) { return 4 * sizeof(Scalar); }
+  static void serialize(const T &q, char *out) {
+    std::memcpy(out, q.coeffs().data(), 4 * sizeof(Scalar));
+  }
+  static bool deserialize(const char *in, const size_t size, T &q) {
+    if (size != 4 * sizeof(Scalar)) {
+      return false;
+    }
+    std::memcpy(q.coeffs().data(), in, 4 * sizeof(Scalar));
+    return true;
+  }
+};
+
 } // namespace msync
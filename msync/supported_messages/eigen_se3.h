@@ -70,4 +70,91 @@ struct LinearInterpolaterTraits<Eigen::Matrix<Scalar, 7, 1>> {
   }
 };
 
+// se3 batch interpolater traits, translation of plus is linear in ratio,
+// from.t + r * from.q(v), rotation goes through the quaternion batch traits
+template <typename Scalar>
+struct BatchInterpolaterTraits<
+    Eigen::Matrix<Scalar, 7, 1>,
+    LinearInterpolaterTraits<Eigen::Matrix<Scalar, 7, 1>>> {
+  using T = Eigen::Matrix<Scalar, 7, 1>;
+  using Tangent = Eigen::Matrix<Scalar, 6, 1>;
+  using Translation = Eigen::Matrix<Scalar, 3, 1>;
+  using Rotation = Eigen::Quaternion<Scalar>;
+  using RotationBatch = BatchInterpolaterTraits<Rotation>;
+
+  static constexpr size_t kChunk = RotationBatch::kChunk;
+
+  static void plus(const T &from, const Tangent &tangent,
+                   const double *ratios, const size_t n, T *out) {
+    const Rotation q(from(3), from(4), from(5), from(6));
+    const Translation t = from.template head<3>();
+    const Translation v = q._transformVector(tangent.template head<3>());
+    const Translation w = tangent.template tail<3>();
+    Rotation rotations[kChunk];
+    for (size_t first = 0; first < n; first += kChunk) {
+      const size_t m = std::min(kChunk, n - first);
+      RotationBatch::plus(q, w, ratios + first, m, rotations);
+      for (size_t i = 0; i < m; ++i) {
+        T &se3 = out[first + i];
+        se3.template head<3>() = t + v * Scalar(ratios[first + i]);
+        se3.template tail<4>() << rotations[i].w(), rotations[i].x(),
+            rotations[i].y(), rotations[i].z();
+      }
+    }
+  }
+};
+
+// se3 fast interpolater traits, translation is interpolated linearly and
+// rotation by the fast slerp of quaternion, independent of each other
+template <typename Scalar>
+struct FastInterpolaterTraits<Eigen::Matrix<Scalar, 7, 1>> {
+  using T = Eigen::Matrix<Scalar, 7, 1>;
+  using Translation = Eigen::Matrix<Scalar, 3, 1>;
+  using Rotation = Eigen::Quaternion<Scalar>;
+  using RotationTraits = FastInterpolaterTraits<Rotation>;
+
+  struct Tangent {
+    Tangent operator*(const double ratio) const {
+      return {translation * Scalar(ratio), rotation * ratio};
+    }
+
+    Translation translation;
+    typename RotationTraits::Tangent rotation;
+  };
+
+  static T plus(const T &from, const Tangent &tangent) {
+    const Rotation q = RotationTraits::plus(
+        Rotation(from(3), from(4), from(5), from(6)), tangent.rotation);
+    T se3;
+    se3.template head<3>() = from.template head<3>() + tangent.translation;
+    se3.template tail<4>() << q.w(), q.x(), q.y(), q.z();
+    return se3;
+  }
+
+  static Tangent between(const T &from, const T &to) {
+    const Rotation from_q(from(3), from(4), from(5), from(6));
+    const Rotation to_q(to(3), to(4), to(5), to(6));
+    return {to.template head<3>() - from.template head<3>(),
+            RotationTraits::between(from_q, to_q)};
+  }
+};
+
+// se3 serializer traits, the 7 data in order
+template <typename Scalar>
+struct SerializerTraits<Eigen::Matrix<Scalar, 7, 1>> {
+  using T = Eigen::Matrix<Scalar, 7, 1>;
+
+  static size_t size(const T &) { return 7 * sizeof(Scalar); }
+  static void serialize(const T &se3, char *out) {
+    std::memcpy(out, se3.data(), 7 * sizeof(Scalar));
+  }
+  static bool deserialize(const char *in, const size_t size, T &se3) {
+    if (size != 7 * sizeof(Scalar)) {
+      return false;
+    }
+    std::memcpy(se3.data(), in, 7 * sizeof(Scalar));
+    return true;
+  }
+};
+
 } // namespace msync
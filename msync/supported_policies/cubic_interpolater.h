@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "../policy.h"
+#include "../traits.h"
+
+#include "../supported_storages/map_storage.h"
+
+namespace msync {
+
+// Cubic interpolate policy, default to use MapStorage
+template <typename _MsgType,
+          typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
+          typename _Storage = MapStorage<_MsgType, _Alloc>>
+struct CubicInterpolatePolicy;
+
+template <typename _MsgType, typename _Alloc, typename _Storage>
+struct PolicyTraits<CubicInterpolatePolicy<_MsgType, _Alloc, _Storage>> {
+  using MsgType = _MsgType;
+  using InType = MsgType;
+  using OutType = std::pair<MsgType, bool>;
+  using Storage = _Storage;
+};
+
+// Catmull-Rom (cubic hermite) interpolation through the two messages around
+// peek time, with tangents from their neighbours. p0..p3 are taken to the
+// chart at p1 by between, so the curve is
+//   plus(p1, a s + b s^2 + c s^3), s = (time - t1) / (t2 - t1)
+// which passes p1 at s = 0 and p2 at s = 1 exactly. tangent at p1 is
+// (y2 - y0) / (t2 - t0) in the chart, at p2 (y3 - y1) / (t3 - t1), one
+// sided if p0 or p3 does not exist. past the newest message it goes on
+// along the end tangent up to predict_win. a, b and c are kept for the
+// last segment peeked. needs Tangent of LinearInterpolaterTraits to be a
+// vector space, e.g. double or eigen vectors.
+template <typename _MsgType, typename _Alloc, typename _Storage>
+struct CubicInterpolatePolicy
+    : public Policy<CubicInterpolatePolicy<_MsgType, _Alloc, _Storage>> {
+  using Base = Policy<CubicInterpolatePolicy<_MsgType, _Alloc, _Storage>>;
+  using MsgType = _MsgType;
+
+  using Interpolater = LinearInterpolaterTraits<MsgType>;
+  using Tangent = std::decay_t<decltype(Interpolater::between(
+      std::declval<MsgType>(), std::declval<MsgType>()))>;
+
+  using Base::reportSkew;
+  using Base::storage_;
+
+  CubicInterpolatePolicy(const Time history_win = 1e6,
+                         const Time predict_win = 5e5,
+                         const PolicyAttribute attr = kNormal,
+                         const _Alloc &alloc = _Alloc())
+      : Base(history_win, attr, alloc), predict_win_(predict_win) {
+    stamps_.fill(std::numeric_limits<Time>::lowest());
+  }
+
+  std::pair<MsgType, bool> doPeek(const Time time) const {
+    std::pair<MsgType, bool> ret;
+    ret.second = false;
+
+    auto pre = storage_.findPre(time);
+    auto suc = storage_.findSuc(time);
+
+    if (pre == storage_.end())
+      return ret;
+
+    if (time == pre->first) {
+      reportSkew(0);
+      ret.first = pre->second;
+      ret.second = true;
+      return ret;
+    }
+
+    if (suc == storage_.end() && storage_.size() < 2)
+      return ret;
+
+    auto low = pre;
+    auto hig = suc;
+    if (suc == storage_.end()) {
+      low = std::prev(pre);
+      hig = pre;
+    }
+
+    // extapolate too far
+    if (time - hig->first > predict_win_) {
+      return ret;
+    }
+
+    // do interpolate, or go on along end tangent past hig
+    coefficients(low, hig);
+    const double s = (time - low->first) / double(hig->first - low->first);
+    Tangent x;
+    if (s <= 1.0) {
+      x = ((c_ * s + b_) * s + a_) * s;
+    } else {
+      x = a_ + b_ + c_ + (a_ + b_ * 2.0 + c_ * 3.0) * (s - 1.0);
+    }
+    reportSkew(suc == storage_.end()
+                   ? time - pre->first
+                   : std::min(time - pre->first, suc->first - time));
+    ret.first = Interpolater::plus(low->second, x);
+    ret.second = true;
+    return ret;
+  }
+
+protected:
+  // coefficients of segment from low to hig, memoized for the last segment
+  // together with its neighbours, since a neighbour arriving later changes
+  // them. stamps only increase, so the four stamps name them
+  template <typename _Iter>
+  void coefficients(const _Iter low, const _Iter hig) const {
+    const bool has_p0 = low != storage_.begin();
+    const auto next = std::next(hig);
+    const bool has_p3 = next != storage_.end();
+    const std::array<Time, 4> stamps{
+        has_p0 ? std::prev(low)->first : std::numeric_limits<Time>::lowest(),
+        low->first, hig->first,
+        has_p3 ? next->first : std::numeric_limits<Time>::max()};
+    if (stamps == stamps_) {
+      return;
+    }
+    stamps_ = stamps;
+
+    // tangents in the chart at p1, scaled by segment length h
+    const double h = double(stamps[2] - stamps[1]);
+    const Tangent y2 = Interpolater::between(low->second, hig->second);
+    const Tangent m1 =
+        has_p0 ? (y2 - Interpolater::between(low->second,
+                                             std::prev(low)->second)) *
+                     (h / double(stamps[2] - stamps[0]))
+               : y2;
+    const Tangent m2 =
+        has_p3 ? Interpolater::between(low->second, next->second) *
+                     (h / double(stamps[3] - stamps[1]))
+               : y2;
+
+    a_ = m1;
+    b_ = y2 * 3.0 - m1 * 2.0 - m2;
+    c_ = m1 + m2 - y2 * 2.0;
+  }
+
+protected:
+  Time predict_win_;
+
+  mutable std::array<Time, 4> stamps_;
+  mutable Tangent a_;
+  mutable Tangent b_;
+  mutable Tangent c_;
+};
+
+} // namespace msync
@@ -7,42 +7,57 @@
 
 namespace msync {
 
-// Exact time policy, default to use MapStorage
+// Exact time policy, default to use MapStorage and copy peeked message out
 template <typename _MsgType,
           typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
-          typename _Storage = MapStorage<_MsgType, _Alloc>>
+          typename _Storage = MapStorage<_MsgType, _Alloc>,
+          PeekMode _Mode = kPeekCopy>
 struct ExactTimePolicy;
 
-template <typename _MsgType, typename _Alloc, typename _Storage>
-struct PolicyTraits<ExactTimePolicy<_MsgType, _Alloc, _Storage>> {
+// Exact time policy which peeks pointer into storage instead of copy
+template <typename _MsgType,
+          typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
+          typename _Storage = MapStorage<_MsgType, _Alloc>>
+using ExactTimeRefPolicy =
+    ExactTimePolicy<_MsgType, _Alloc, _Storage, kPeekRef>;
+
+template <typename _MsgType, typename _Alloc, typename _Storage,
+          PeekMode _Mode>
+struct PolicyTraits<ExactTimePolicy<_MsgType, _Alloc, _Storage, _Mode>> {
   using MsgType = _MsgType;
   using InType = MsgType;
-  using OutType = std::pair<MsgType, bool>;
+  using OutType = typename PeekOutTraits<MsgType, _Mode>::OutType;
   using Storage = _Storage;
 };
 
-template <typename _MsgType, typename _Alloc, typename _Storage>
+template <typename _MsgType, typename _Alloc, typename _Storage,
+          PeekMode _Mode>
 struct ExactTimePolicy
-    : public Policy<ExactTimePolicy<_MsgType, _Alloc, _Storage>> {
-  using Base = Policy<ExactTimePolicy<_MsgType, _Alloc, _Storage>>;
+    : public Policy<ExactTimePolicy<_MsgType, _Alloc, _Storage, _Mode>> {
+  using Base = Policy<ExactTimePolicy<_MsgType, _Alloc, _Storage, _Mode>>;
   using MsgType = _MsgType;
+  using OutType = typename Base::OutType;
+  using Out = PeekOutTraits<MsgType, _Mode>;
+
+  static_assert(_Mode != kPeekRef || StableItems<_Storage>::value,
+                "kPeekRef needs a storage keeping items until the next push");
 
+  using Base::reportSkew;
   using Base::storage_;
 
   ExactTimePolicy(const Time history_win = 1e6,
-                  const PolicyAttribute attr = kNormal)
-      : Base(history_win, attr) {}
+                  const PolicyAttribute attr = kNormal,
+                  const _Alloc &alloc = _Alloc())
+      : Base(history_win, attr, alloc) {}
 
-  virtual std::pair<MsgType, bool> doPeek(const Time time) const override {
-    std::pair<MsgType, bool> ret;
+  OutType doPeek(const Time time) const {
     auto found = storage_.find(time);
     if (found == storage_.end()) {
-      ret.second = false;
+      return Out::none();
     } else {
-      ret.first = found->second;
-      ret.second = true;
+      reportSkew(0);
+      return Out::some(found->second);
     }
-    return ret;
   }
 };
 
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "../policy.h"
 #include "../traits.h"
 
@@ -7,34 +14,58 @@
 
 namespace msync {
 
-// Linear interpolate policy, default to use MapStorage
+// Linear interpolate policy, default to use MapStorage and interpolate by
+// LinearInterpolaterTraits
 template <typename _MsgType,
           typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
-          typename _Storage = MapStorage<_MsgType, _Alloc>>
+          typename _Storage = MapStorage<_MsgType, _Alloc>,
+          typename _Interpolater = LinearInterpolaterTraits<_MsgType>>
 struct LinearInterpolatePolicy;
 
-template <typename _MsgType, typename _Alloc, typename _Storage>
-struct PolicyTraits<LinearInterpolatePolicy<_MsgType, _Alloc, _Storage>> {
+// Linear interpolate policy by FastInterpolaterTraits, e.g. polynomial
+// slerp for quaternion and se3, see there for its accuracy
+template <typename _MsgType,
+          typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
+          typename _Storage = MapStorage<_MsgType, _Alloc>>
+using FastLinearInterpolatePolicy =
+    LinearInterpolatePolicy<_MsgType, _Alloc, _Storage,
+                            FastInterpolaterTraits<_MsgType>>;
+
+template <typename _MsgType, typename _Alloc, typename _Storage,
+          typename _Interpolater>
+struct PolicyTraits<
+    LinearInterpolatePolicy<_MsgType, _Alloc, _Storage, _Interpolater>> {
   using MsgType = _MsgType;
   using InType = MsgType;
   using OutType = std::pair<MsgType, bool>;
   using Storage = _Storage;
 };
 
-template <typename _MsgType, typename _Alloc, typename _Storage>
+template <typename _MsgType, typename _Alloc, typename _Storage,
+          typename _Interpolater>
 struct LinearInterpolatePolicy
-    : public Policy<LinearInterpolatePolicy<_MsgType, _Alloc, _Storage>> {
-  using Base = Policy<LinearInterpolatePolicy<_MsgType, _Alloc, _Storage>>;
+    : public Policy<
+          LinearInterpolatePolicy<_MsgType, _Alloc, _Storage, _Interpolater>> {
+  using Base = Policy<
+      LinearInterpolatePolicy<_MsgType, _Alloc, _Storage, _Interpolater>>;
   using MsgType = _MsgType;
 
+  using Interpolater = _Interpolater;
+  using Tangent = std::decay_t<decltype(Interpolater::between(
+      std::declval<MsgType>(), std::declval<MsgType>()))>;
+
+  using Base::reportSkew;
   using Base::storage_;
 
   LinearInterpolatePolicy(const Time history_win = 1e6,
                           const Time predict_win = 5e5,
-                          const PolicyAttribute attr = kNormal)
-      : Base(history_win, attr), predict_win_(predict_win) {}
+                          const PolicyAttribute attr = kNormal,
+                          const _Alloc &alloc = _Alloc())
+      : Base(history_win, attr, alloc), predict_win_(predict_win),
+        segment_(std::numeric_limits<Time>::lowest(),
+                 std::numeric_limits<Time>::lowest()) {}
 
-  virtual std::pair<MsgType, bool> doPeek(const Time time) const override {
+  std::pair<MsgType, bool> doPeek(const Time time) const {
     std::pair<MsgType, bool> ret;
     ret.second = false;
 
@@ -50,6 +81,7 @@ struct LinearInterpolatePolicy
       return ret;
 
     if (time == pre->first) {
+      reportSkew(0);
       ret.first = pre->second;
       ret.second = true;
       return ret;
@@ -67,16 +99,108 @@ struct LinearInterpolatePolicy
 
     // do interpolate
     double ratio = (time - low->first) / double(hig->first - low->first);
-    ret.first = LinearInterpolaterTraits<MsgType>::plus(
-        low->second,
-        LinearInterpolaterTraits<MsgType>::between(low->second, hig->second) *
-            ratio);
+    reportSkew(suc == storage_.end()
+                   ? time - pre->first
+                   : std::min(time - pre->first, suc->first - time));
+    ret.first = Interpolater::plus(low->second, tangent(*low, *hig) * ratio);
     ret.second = true;
     return ret;
   }
 
+  // one merge pass of sorted times over storage, times in one segment are
+  // interpolated together by BatchInterpolaterTraits
+  void doPeekBatch(const Time *times, const size_t n,
+                   std::pair<MsgType, bool> *outs) const {
+    if (!std::is_sorted(times, times + n)) {
+      Base::doPeekBatch(times, n, outs);
+      return;
+    }
+
+    const auto end = storage_.end();
+    auto suc = n > 0 ? storage_.findSuc(times[0]) : end;
+    size_t i = 0;
+    while (i < n) {
+      const Time time = times[i];
+      while (suc != end && suc->first <= time) {
+        ++suc;
+      }
+
+      // same cases as doPeek
+      if (suc == storage_.begin()) {
+        outs[i++].second = false;
+        continue;
+      }
+
+      auto pre = std::prev(suc);
+      if (time == pre->first) {
+        outs[i++] = {pre->second, true};
+        continue;
+      }
+
+      if (suc == end && storage_.size() < 2) {
+        outs[i++].second = false;
+        continue;
+      }
+
+      auto low = pre;
+      auto hig = suc;
+      if (suc == end) {
+        low = std::prev(pre);
+        hig = pre;
+      }
+
+      // times up to the next stamp, or within predict window past the last
+      const Time last = suc != end ? hig->first - 1 : hig->first + predict_win_;
+      size_t j = i;
+      while (j < n && times[j] <= last) {
+        ++j;
+      }
+      if (j == i) {
+        for (; i < n; ++i) {
+          outs[i].second = false;
+        }
+        break;
+      }
+
+      const double span = double(hig->first - low->first);
+      ratios_.resize(j - i);
+      batch_.resize(j - i);
+      for (size_t k = i; k < j; ++k) {
+        ratios_[k - i] = (times[k] - low->first) / span;
+      }
+      BatchInterpolaterTraits<MsgType, Interpolater>::plus(
+          low->second, tangent(*low, *hig), ratios_.data(), j - i,
+          batch_.data());
+      for (size_t k = i; k < j; ++k) {
+        outs[k] = {std::move(batch_[k - i]), true};
+      }
+      i = j;
+    }
+  }
+
+protected:
+  // tangent of segment from low to hig, memoized for the last segment since
+  // consecutive peeks mostly fall in it, e.g. several syncronizers at one
+  // master stamp or retries after not ready. stamps only increase, so the
+  // stamp pair names the segment
+  template <typename _Item>
+  const Tangent &tangent(const _Item &low, const _Item &hig) const {
+    if (segment_.first != low.first || segment_.second != hig.first) {
+      segment_ = {low.first, hig.first};
+      tangent_ = Interpolater::between(low.second, hig.second);
+    }
+    return tangent_;
+  }
+
 protected:
   Time predict_win_;
+
+  mutable std::pair<Time, Time> segment_;
+  mutable Tangent tangent_;
+
+  // buffers of batch peek, reused so no allocation once sized
+  mutable std::vector<double> ratios_;
+  mutable std::vector<MsgType> batch_;
 };
 
 } // namespace msync
@@ -10,36 +10,49 @@
 
 namespace msync {
 
-// Nearest policy, default to use MapStorage
+// Nearest policy, default to use MapStorage and copy peeked message out
 template <typename _MsgType,
           typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
-          typename _Storage = MapStorage<_MsgType, _Alloc>>
+          typename _Storage = MapStorage<_MsgType, _Alloc>,
+          PeekMode _Mode = kPeekCopy>
 struct NearestPolicy;
 
-template <typename _MsgType, typename _Alloc, typename _Storage>
-struct PolicyTraits<NearestPolicy<_MsgType, _Alloc, _Storage>> {
+// Nearest policy which peeks pointer into storage instead of copy
+template <typename _MsgType,
+          typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
+          typename _Storage = MapStorage<_MsgType, _Alloc>>
+using NearestRefPolicy = NearestPolicy<_MsgType, _Alloc, _Storage, kPeekRef>;
+
+template <typename _MsgType, typename _Alloc, typename _Storage,
+          PeekMode _Mode>
+struct PolicyTraits<NearestPolicy<_MsgType, _Alloc, _Storage, _Mode>> {
   using MsgType = _MsgType;
   using InType = MsgType;
-  using OutType = std::pair<MsgType, bool>;
+  using OutType = typename PeekOutTraits<MsgType, _Mode>::OutType;
   using Storage = _Storage;
 };
 
-template <typename _MsgType, typename _Alloc, typename _Storage>
+template <typename _MsgType, typename _Alloc, typename _Storage,
+          PeekMode _Mode>
 struct NearestPolicy
-    : public Policy<NearestPolicy<_MsgType, _Alloc, _Storage>> {
-  using Base = Policy<NearestPolicy<_MsgType, _Alloc, _Storage>>;
+    : public Policy<NearestPolicy<_MsgType, _Alloc, _Storage, _Mode>> {
+  using Base = Policy<NearestPolicy<_MsgType, _Alloc, _Storage, _Mode>>;
   using MsgType = _MsgType;
+  using OutType = typename Base::OutType;
+  using Out = PeekOutTraits<MsgType, _Mode>;
+
+  static_assert(_Mode != kPeekRef || StableItems<_Storage>::value,
+                "kPeekRef needs a storage keeping items until the next push");
 
+  using Base::reportSkew;
   using Base::storage_;
 
   NearestPolicy(const Time history_win = 1e6, const Time valid_win = 5e5,
-                const PolicyAttribute attr = kNormal)
-      : Base(history_win, attr), valid_win_(valid_win) {}
-
-  virtual std::pair<MsgType, bool> doPeek(const Time time) const override {
-    std::pair<MsgType, bool> ret;
-    ret.second = false;
+                const PolicyAttribute attr = kNormal,
+                const _Alloc &alloc = _Alloc())
+      : Base(history_win, attr, alloc), valid_win_(valid_win) {}
 
+  OutType doPeek(const Time time) const {
     Time delta_min = std::numeric_limits<Time>::max();
     int sel = -1;
     auto pre = storage_.findPre(time);
@@ -62,11 +75,10 @@ struct NearestPolicy
     }
 
     if (delta_min > valid_win_ || sel < 0)
-      return ret;
+      return Out::none();
 
-    ret.first = sel == 0 ? pre->second : suc->second;
-    ret.second = true;
-    return ret;
+    reportSkew(delta_min);
+    return Out::some(sel == 0 ? pre->second : suc->second);
   }
 
 protected:
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdlib>
+
 #include "../policy.h"
 #include "../traits.h"
 
@@ -7,39 +9,55 @@
 
 namespace msync {
 
-// Newest policy, default to use MapStorage
+// Newest policy, default to use MapStorage and copy peeked message out
 template <typename _MsgType,
           typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
-          typename _Storage = MapStorage<_MsgType, _Alloc>>
+          typename _Storage = MapStorage<_MsgType, _Alloc>,
+          PeekMode _Mode = kPeekCopy>
 struct NewestPolicy;
 
-template <typename _MsgType, typename _Alloc, typename _Storage>
-struct PolicyTraits<NewestPolicy<_MsgType, _Alloc, _Storage>> {
+// Newest policy which peeks pointer into storage instead of copy
+template <typename _MsgType,
+          typename _Alloc = std::allocator<std::pair<const Time, _MsgType>>,
+          typename _Storage = MapStorage<_MsgType, _Alloc>>
+using NewestRefPolicy = NewestPolicy<_MsgType, _Alloc, _Storage, kPeekRef>;
+
+template <typename _MsgType, typename _Alloc, typename _Storage,
+          PeekMode _Mode>
+struct PolicyTraits<NewestPolicy<_MsgType, _Alloc, _Storage, _Mode>> {
   using MsgType = _MsgType;
   using InType = MsgType;
-  using OutType = std::pair<MsgType, bool>;
+  using OutType = typename PeekOutTraits<MsgType, _Mode>::OutType;
   using Storage = _Storage;
 };
 
-template <typename _MsgType, typename _Alloc, typename _Storage>
-struct NewestPolicy : public Policy<NewestPolicy<_MsgType, _Alloc, _Storage>> {
-  using Base = Policy<NewestPolicy<_MsgType, _Alloc, _Storage>>;
+template <typename _MsgType, typename _Alloc, typename _Storage,
+          PeekMode _Mode>
+struct NewestPolicy
+    : public Policy<NewestPolicy<_MsgType, _Alloc, _Storage, _Mode>> {
+  using Base = Policy<NewestPolicy<_MsgType, _Alloc, _Storage, _Mode>>;
   using MsgType = _MsgType;
+  using OutType = typename Base::OutType;
+  using Out = PeekOutTraits<MsgType, _Mode>;
 
-  using Base::storage_;
+  static_assert(_Mode != kPeekRef || StableItems<_Storage>::value,
+                "kPeekRef needs a storage keeping items until the next push");
 
-  NewestPolicy(const Time history_win = 0, const PolicyAttribute attr = kNormal)
-      : Base(history_win, attr) {}
+  using Base::reportSkew;
+  using Base::storage_;
 
-  virtual std::pair<MsgType, bool> doPeek(const Time) const override {
-    std::pair<MsgType, bool> ret{MsgType{}, false};
+  NewestPolicy(const Time history_win = 0, const PolicyAttribute attr = kNormal,
+               const _Alloc &alloc = _Alloc())
+      : Base(history_win, attr, alloc) {}
 
-    if (!storage_.empty()) {
-      ret.first = storage_.back().second;
-      ret.second = true;
+  OutType doPeek(const Time time) const {
+    if (storage_.empty()) {
+      return Out::none();
+    } else {
+      auto back = std::prev(storage_.end());
+      reportSkew(std::abs(time - back->first));
+      return Out::some(back->second);
     }
-
-    return ret;
   }
 };
 
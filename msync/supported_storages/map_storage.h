@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <tuple>
+#include <utility>
 
 #include "../storage.h"
 #include "../traits.h"
@@ -26,29 +28,75 @@ struct MapStorage : public StorageBase<MapStorage<_Msg, _Alloc>> {
   using MsgType = typename StorageTraits<MapStorage>::MsgType;
   using ConstIter = typename StorageTraits<MapStorage>::ConstIter;
 
-  using Base::history_win_;
+  MapStorage(const Time history_win)
+      : Base(history_win), cursor_(stamp2msg_.end()) {}
 
-  MapStorage(const Time history_win) : Base(history_win) {}
+  MapStorage(const Time history_win, const _Alloc &alloc)
+      : Base(history_win), stamp2msg_(alloc), cursor_(stamp2msg_.end()) {}
+
+  // cursor points into the map it belongs to, so it is not copied
+  MapStorage(const MapStorage &other)
+      : Base(other), stamp2msg_(other.stamp2msg_), cursor_(stamp2msg_.end()) {}
+
+  // noexcept, so vectors of policies move storages when they grow
+  MapStorage(MapStorage &&other) noexcept
+      : Base(other), stamp2msg_(std::move(other.stamp2msg_)),
+        cursor_(stamp2msg_.end()) {
+    other.cursor_ = other.stamp2msg_.end();
+  }
+
+  MapStorage &operator=(const MapStorage &other) {
+    Base::operator=(other);
+    stamp2msg_ = other.stamp2msg_;
+    cursor_ = stamp2msg_.end();
+    return *this;
+  }
+
+  MapStorage &operator=(MapStorage &&other) noexcept {
+    Base::operator=(other);
+    stamp2msg_ = std::move(other.stamp2msg_);
+    cursor_ = stamp2msg_.end();
+    other.cursor_ = other.stamp2msg_.end();
+    return *this;
+  }
 
   // interface implementations
 
   bool pushImpl(const Time &time, const MsgType &msg) {
+    return emplaceImpl(time, msg);
+  }
+
+  bool pushImpl(const Time &time, MsgType &&msg) {
+    return emplaceImpl(time, std::move(msg));
+  }
+
+  template <typename... _Args>
+  bool emplaceImpl(const Time &time, _Args &&...args) {
     // check stamp monotonicity
     if (!stamp2msg_.empty() && time <= stamp2msg_.rbegin()->first) {
       return false;
     }
 
-    // seems everything ok, insert time msg pair
-    stamp2msg_.insert({time, msg});
+    // seems everything ok, construct time msg pair in place at tail
+    stamp2msg_.emplace_hint(
+        stamp2msg_.end(), std::piecewise_construct, std::forward_as_tuple(time),
+        std::forward_as_tuple(std::forward<_Args>(args)...));
 
-    // check if we should remove the old ones
-    if (stamp2msg_.begin()->first < time - history_win_) {
-      stamp2msg_.erase(stamp2msg_.begin());
-    }
+    // remove the old ones out of history window
+    evictBeforeImpl(this->windowStart(time));
 
     return true;
   }
 
+  void evictBeforeImpl(const Time time) {
+    while (!stamp2msg_.empty() && stamp2msg_.begin()->first < time) {
+      if (cursor_ == stamp2msg_.begin()) {
+        cursor_ = stamp2msg_.end();
+      }
+      stamp2msg_.erase(stamp2msg_.begin());
+    }
+  }
+
   size_t sizeImpl() const { return stamp2msg_.size(); }
 
   bool emptyImpl() const { return stamp2msg_.empty(); }
@@ -57,16 +105,19 @@ struct MapStorage : public StorageBase<MapStorage<_Msg, _Alloc>> {
 
   ConstIter endImpl() const { return stamp2msg_.end(); }
 
-  ConstIter findImpl(const Time time) const { return stamp2msg_.find(time); }
+  ConstIter findImpl(const Time time) const {
+    findPreImpl(time);
+    return cursor_ != stamp2msg_.end() && cursor_->first == time
+               ? cursor_
+               : stamp2msg_.end();
+  }
 
   ConstIter findPreImpl(const Time time) const {
-    auto upper = stamp2msg_.upper_bound(time);
-    return upper != stamp2msg_.begin() ? std::prev(upper) : stamp2msg_.end();
+    upperBound(time);
+    return cursor_;
   }
 
-  ConstIter findSucImpl(const Time time) const {
-    return stamp2msg_.upper_bound(time);
-  }
+  ConstIter findSucImpl(const Time time) const { return upperBound(time); }
 
   std::pair<Time, MsgType> frontImpl() const { return *stamp2msg_.begin(); }
 
@@ -76,8 +127,50 @@ struct MapStorage : public StorageBase<MapStorage<_Msg, _Alloc>> {
 
   Time backStampImpl() const { return stamp2msg_.rbegin()->first; }
 
+protected:
+  // first item with stamp LARGE(>) than time, query times mostly move
+  // forward a few items at a time, so walk from the cursor of the last query
+  // and fall back to tree search when it is too far away
+  ConstIter upperBound(const Time time) const {
+    static constexpr int kMaxWalk = 8;
+
+    if (cursor_ != stamp2msg_.end()) {
+      auto iter = cursor_;
+      if (iter->first <= time) {
+        for (int i = 0; i < kMaxWalk; ++i) {
+          auto next = std::next(iter);
+          if (next == stamp2msg_.end() || next->first > time) {
+            cursor_ = iter;
+            return next;
+          }
+          iter = next;
+        }
+      } else {
+        for (int i = 0; i < kMaxWalk; ++i) {
+          if (iter == stamp2msg_.begin()) {
+            cursor_ = stamp2msg_.end();
+            return iter;
+          }
+          auto prev = std::prev(iter);
+          if (prev->first <= time) {
+            cursor_ = prev;
+            return iter;
+          }
+          iter = prev;
+        }
+      }
+    }
+
+    auto upper = stamp2msg_.upper_bound(time);
+    cursor_ = upper != stamp2msg_.begin() ? std::prev(upper) : stamp2msg_.end();
+    return upper;
+  }
+
 protected:
   TimeMsgMap<_Msg, _Alloc> stamp2msg_;
+
+  // last item NO LARGE(<=) than last queried time, end if none
+  mutable ConstIter cursor_;
 };
 
 } // namespace msync
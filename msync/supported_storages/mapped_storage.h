@@ -0,0 +1,393 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "../storage.h"
+#include "../traits.h"
+#include "ring_storage.h"
+
+namespace msync {
+
+template <typename _Msg,
+          typename _Alloc = std::allocator<std::pair<const Time, _Msg>>>
+struct MappedStorage;
+
+template <typename _Msg, typename _Alloc>
+struct StorageTraits<MappedStorage<_Msg, _Alloc>> {
+  using MsgType = _Msg;
+  using ConstIter = RingConstIter<MappedStorage<_Msg, _Alloc>>;
+
+  // a cached page may be read over by peeks before the next push
+  static constexpr bool kStableItems = false;
+};
+
+// Storage backed by a file of fixed size records, for history windows too
+// long to be held in memory, e.g. hours of poses. Only the packed stamp
+// index stays in memory, items are read on demand a page at a time into a
+// few cached pages, the newest page is kept there while it is filled. The
+// file is unlinked once opened, so nothing is left behind. When evicted
+// records outnumber live ones, live records are moved to the file start and
+// the file is cut after them, so it stays within about twice the history
+// window.
+//
+// Records are { int64 stamp, uint64 size, payload }, payload is written by
+// SerializerTraits and may not be larger than sizeof(_Msg), which holds for
+// fixed size messages. An item referenced by iterator stays valid until
+// kCachePages - 1 other pages have been read, so ref peek policies refuse
+// this storage, see StableItems. Compaction truncates the file too.
+template <typename _Msg, typename _Alloc>
+struct MappedStorage : public StorageBase<MappedStorage<_Msg, _Alloc>> {
+  using Base = StorageBase<MappedStorage<_Msg, _Alloc>>;
+  using MsgType = typename StorageTraits<MappedStorage>::MsgType;
+  using ConstIter = typename StorageTraits<MappedStorage>::ConstIter;
+  using Item = std::pair<Time, MsgType>;
+
+  using StampAlloc =
+      typename std::allocator_traits<_Alloc>::template rebind_alloc<Time>;
+
+  static constexpr size_t kPageItems = 256;
+  static constexpr size_t kCachePages = 4;
+  static constexpr size_t kRecordSize = 16 + sizeof(MsgType);
+
+  // backing file is created in dir, empty for $TMPDIR or /tmp
+  MappedStorage(const Time history_win, const std::string &dir = "")
+      : Base(history_win), dir_(dir) {
+    open();
+  }
+
+  MappedStorage(const Time history_win, const _Alloc &alloc,
+                const std::string &dir = "")
+      : Base(history_win), dir_(dir), stamps_(StampAlloc(alloc)) {
+    open();
+  }
+
+  // the copy gets its own file in the same dir
+  MappedStorage(const MappedStorage &other)
+      : Base(other), dir_(other.dir_),
+        stamps_(std::allocator_traits<StampAlloc>::
+                    select_on_container_copy_construction(
+                        other.stamps_.get_allocator())) {
+    if (open()) {
+      copyFrom(other);
+    }
+  }
+
+  // noexcept, so vectors of policies move storages instead of copying files
+  MappedStorage(MappedStorage &&other) noexcept
+      : Base(other), stamps_(other.stamps_.get_allocator()) {
+    swap(other);
+  }
+
+  MappedStorage &operator=(const MappedStorage &other) {
+    if (this != &other) {
+      MappedStorage copied(other);
+      swap(copied);
+    }
+    return *this;
+  }
+
+  MappedStorage &operator=(MappedStorage &&other) noexcept {
+    Base::operator=(other);
+    swap(other);
+    return *this;
+  }
+
+  ~MappedStorage() {
+    if (file_ != nullptr) {
+      std::fclose(file_);
+    }
+  }
+
+  // false if backing file could not be created or an io failed
+  bool ok() const { return file_ != nullptr && !failed_; }
+
+  // interface implementations
+
+  bool pushImpl(const Time &time, const MsgType &msg) {
+    // check stamp monotonicity
+    if (!ok() || (size_ > 0 && time <= backStampImpl()) ||
+        SerializerTraits<MsgType>::size(msg) > sizeof(MsgType)) {
+      return false;
+    }
+
+    // seems everything ok, append record and its stamp
+    const size_t slot = first_ + size_;
+    write(slot, time, msg);
+    stamps_.push_back(time);
+    ++size_;
+
+    // remove the old ones out of history window
+    evictBeforeImpl(this->windowStart(time));
+
+    return true;
+  }
+
+  bool pushImpl(const Time &time, MsgType &&msg) {
+    return pushImpl(time, static_cast<const MsgType &>(msg));
+  }
+
+  template <typename... _Args>
+  bool emplaceImpl(const Time &time, _Args &&...args) {
+    return pushImpl(time, MsgType(std::forward<_Args>(args)...));
+  }
+
+  void evictBeforeImpl(const Time time) {
+    const auto first = stamps_.begin() + first_;
+    const size_t n =
+        std::lower_bound(first, first + size_, time) - first;
+    first_ += n;
+    size_ -= n;
+    if (first_ >= kPageItems && first_ >= size_) {
+      compact();
+    }
+  }
+
+  size_t sizeImpl() const { return size_; }
+
+  bool emptyImpl() const { return size_ == 0; }
+
+  ConstIter beginImpl() const { return ConstIter(this, 0); }
+
+  ConstIter endImpl() const { return ConstIter(this, size_); }
+
+  ConstIter findImpl(const Time time) const {
+    const size_t pos = upperBound(time);
+    return pos > 0 && stamp(pos - 1) == time ? ConstIter(this, pos - 1)
+                                             : endImpl();
+  }
+
+  ConstIter findPreImpl(const Time time) const {
+    const size_t pos = upperBound(time);
+    return pos > 0 ? ConstIter(this, pos - 1) : endImpl();
+  }
+
+  ConstIter findSucImpl(const Time time) const {
+    return ConstIter(this, upperBound(time));
+  }
+
+  std::pair<Time, MsgType> frontImpl() const { return at(0); }
+
+  std::pair<Time, MsgType> backImpl() const { return at(size_ - 1); }
+
+  Time frontStampImpl() const { return stamp(0); }
+
+  Time backStampImpl() const { return stamp(size_ - 1); }
+
+  // item at logical position pos, counted from the front
+  const Item &at(const size_t pos) const {
+    const size_t slot = first_ + pos;
+    return page(slot / kPageItems).items[slot % kPageItems];
+  }
+
+  // pages read from file so far
+  size_t pageReadCount() const { return page_reads_; }
+
+  // bytes of backing file, buffered writes not counted
+  uint64_t fileSize() const {
+    struct stat st;
+    return file_ != nullptr && ::fstat(::fileno(file_), &st) == 0
+               ? uint64_t(st.st_size)
+               : 0;
+  }
+
+protected:
+  struct Page {
+    size_t index = SIZE_MAX;
+    uint64_t used = 0;
+    std::vector<Item> items;
+  };
+
+  Time stamp(const size_t pos) const { return stamps_[first_ + pos]; }
+
+  // logical position of first item with stamp LARGE(>) than time
+  size_t upperBound(const Time time) const {
+    const auto first = stamps_.begin() + first_;
+    return std::upper_bound(first, first + size_, time) - first;
+  }
+
+  bool open() {
+    std::string dir = dir_;
+    if (dir.empty()) {
+      const char *env = std::getenv("TMPDIR");
+      dir = env != nullptr && env[0] != '\0' ? env : "/tmp";
+    }
+    std::string path = dir + "/msync_storage_XXXXXX";
+    const int fd = ::mkstemp(&path[0]);
+    if (fd < 0) {
+      return false;
+    }
+    ::unlink(path.c_str());
+    file_ = ::fdopen(fd, "w+b");
+    if (file_ == nullptr) {
+      ::close(fd);
+    }
+    return file_ != nullptr;
+  }
+
+  void swap(MappedStorage &other) noexcept {
+    std::swap(dir_, other.dir_);
+    std::swap(file_, other.file_);
+    std::swap(failed_, other.failed_);
+    std::swap(writing_, other.writing_);
+    std::swap(offset_, other.offset_);
+    std::swap(stamps_, other.stamps_);
+    std::swap(first_, other.first_);
+    std::swap(size_, other.size_);
+    std::swap(pages_, other.pages_);
+    std::swap(tick_, other.tick_);
+    std::swap(page_reads_, other.page_reads_);
+  }
+
+  void copyFrom(const MappedStorage &other) {
+    for (size_t i = 0; i < other.size_; ++i) {
+      const Item &item = other.at(i);
+      write(i, item.first, item.second);
+      stamps_.push_back(item.first);
+    }
+    size_ = other.size_;
+  }
+
+  // position file at offset for a read or a write, switching between them
+  // needs a seek anyway
+  void seek(const uint64_t offset, const bool writing) {
+    if (offset_ != offset || writing_ != writing) {
+      failed_ |= ::fseeko(file_, off_t(offset), SEEK_SET) != 0;
+      offset_ = offset;
+      writing_ = writing;
+    }
+  }
+
+  void write(const size_t slot, const Time time, const MsgType &msg) {
+    std::array<char, kRecordSize> record{};
+    const uint64_t size = SerializerTraits<MsgType>::size(msg);
+    std::memcpy(record.data(), &time, sizeof(time));
+    std::memcpy(record.data() + 8, &size, sizeof(size));
+    SerializerTraits<MsgType>::serialize(msg, record.data() + 16);
+
+    seek(uint64_t(slot) * kRecordSize, true);
+    failed_ |= std::fwrite(record.data(), 1, kRecordSize, file_) != kRecordSize;
+    offset_ += kRecordSize;
+
+    // keep cached copy coherent, a page just started is cached right away
+    // since there is nothing of it to read
+    const size_t index = slot / kPageItems;
+    Page *cached = this->cached(index);
+    if (cached == nullptr && slot % kPageItems == 0) {
+      cached = &victim();
+      cached->index = index;
+      cached->items.resize(kPageItems);
+    }
+    if (cached != nullptr) {
+      cached->used = ++tick_;
+      cached->items[slot % kPageItems] = Item(time, msg);
+    }
+  }
+
+  Page *cached(const size_t index) const {
+    for (auto &entry : pages_) {
+      if (entry.index == index) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // least recently used page
+  Page &victim() const {
+    return *std::min_element(
+        pages_.begin(), pages_.end(),
+        [](const Page &a, const Page &b) { return a.used < b.used; });
+  }
+
+  const Page &page(const size_t index) const {
+    Page *cached = this->cached(index);
+    if (cached == nullptr) {
+      cached = &victim();
+      cached->index = index;
+      cached->items.resize(kPageItems);
+      read(index, *cached);
+    }
+    cached->used = ++tick_;
+    return *cached;
+  }
+
+  void read(const size_t index, Page &page) const {
+    std::vector<char> buffer(kPageItems * kRecordSize);
+    auto self = const_cast<MappedStorage *>(this);
+    self->seek(uint64_t(index) * kPageItems * kRecordSize, false);
+    const size_t n =
+        std::fread(buffer.data(), kRecordSize, kPageItems, file_);
+    self->offset_ += n * kRecordSize;
+    ++page_reads_;
+
+    for (size_t i = 0; i < n; ++i) {
+      const char *record = buffer.data() + i * kRecordSize;
+      uint64_t size;
+      std::memcpy(&page.items[i].first, record, sizeof(Time));
+      std::memcpy(&size, record + 8, sizeof(size));
+      self->failed_ |= !SerializerTraits<MsgType>::deserialize(
+          record + 16, size, page.items[i].second);
+    }
+  }
+
+  // move live records to the file start, a page at a time, source and
+  // destination never overlap since live records are fewer than evicted
+  void compact() {
+    std::vector<char> buffer(kPageItems * kRecordSize);
+    for (size_t done = 0; done < size_; done += kPageItems) {
+      const size_t n = std::min(kPageItems, size_ - done);
+      seek(uint64_t(first_ + done) * kRecordSize, false);
+      failed_ |= std::fread(buffer.data(), kRecordSize, n, file_) != n;
+      offset_ += n * kRecordSize;
+      seek(uint64_t(done) * kRecordSize, true);
+      failed_ |= std::fwrite(buffer.data(), kRecordSize, n, file_) != n;
+      offset_ += n * kRecordSize;
+    }
+
+    // buffered writes go out before the file is cut after them
+    failed_ |= std::fflush(file_) != 0;
+    failed_ |=
+        ::ftruncate(::fileno(file_), off_t(size_ * kRecordSize)) != 0;
+
+    stamps_.erase(stamps_.begin(), stamps_.begin() + first_);
+    stamps_.resize(size_);
+    first_ = 0;
+    for (auto &entry : pages_) {
+      entry.index = SIZE_MAX;
+      entry.used = 0;
+    }
+  }
+
+protected:
+  std::string dir_;
+  std::FILE *file_ = nullptr;
+  bool failed_ = false;
+
+  // where the file stream is and whether it last wrote
+  bool writing_ = false;
+  uint64_t offset_ = UINT64_MAX;
+
+  // stamp of each record slot in file, live ones are [first_, first_+size_)
+  std::vector<Time, StampAlloc> stamps_;
+  size_t first_ = 0;
+  size_t size_ = 0;
+
+  mutable std::array<Page, kCachePages> pages_;
+  mutable uint64_t tick_ = 0;
+  mutable size_t page_reads_ = 0;
+};
+
+} // namespace msync
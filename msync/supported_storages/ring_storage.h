@@ -0,0 +1,320 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../storage.h"
+#include "../traits.h"
+
+namespace msync {
+
+template <typename _Msg,
+          typename _Alloc = std::allocator<std::pair<const Time, _Msg>>>
+struct RingStorage;
+
+template <typename _Storage> struct RingConstIter;
+
+template <typename _Msg, typename _Alloc>
+struct StorageTraits<RingStorage<_Msg, _Alloc>> {
+  using MsgType = _Msg;
+  using ConstIter = RingConstIter<RingStorage<_Msg, _Alloc>>;
+};
+
+// const iterator of RingStorage and MappedStorage, it walks items in stamp
+// order, position is the logical index counted from the front (oldest) item
+template <typename _Storage> struct RingConstIter {
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename _Storage::Item;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type *;
+  using reference = const value_type &;
+
+  RingConstIter() : storage_(nullptr), pos_(0) {}
+
+  RingConstIter(const _Storage *storage, const size_t pos)
+      : storage_(storage), pos_(pos) {}
+
+  reference operator*() const { return storage_->at(pos_); }
+
+  pointer operator->() const { return &storage_->at(pos_); }
+
+  reference operator[](const difference_type n) const {
+    return storage_->at(pos_ + n);
+  }
+
+  RingConstIter &operator++() {
+    ++pos_;
+    return *this;
+  }
+
+  RingConstIter operator++(int) {
+    RingConstIter old = *this;
+    ++pos_;
+    return old;
+  }
+
+  RingConstIter &operator--() {
+    --pos_;
+    return *this;
+  }
+
+  RingConstIter operator--(int) {
+    RingConstIter old = *this;
+    --pos_;
+    return old;
+  }
+
+  RingConstIter &operator+=(const difference_type n) {
+    pos_ += n;
+    return *this;
+  }
+
+  RingConstIter &operator-=(const difference_type n) {
+    pos_ -= n;
+    return *this;
+  }
+
+  RingConstIter operator+(const difference_type n) const {
+    return RingConstIter(storage_, pos_ + n);
+  }
+
+  RingConstIter operator-(const difference_type n) const {
+    return RingConstIter(storage_, pos_ - n);
+  }
+
+  difference_type operator-(const RingConstIter &other) const {
+    return difference_type(pos_) - difference_type(other.pos_);
+  }
+
+  bool operator==(const RingConstIter &other) const {
+    return pos_ == other.pos_;
+  }
+  bool operator!=(const RingConstIter &other) const {
+    return pos_ != other.pos_;
+  }
+  bool operator<(const RingConstIter &other) const { return pos_ < other.pos_; }
+  bool operator>(const RingConstIter &other) const { return pos_ > other.pos_; }
+  bool operator<=(const RingConstIter &other) const {
+    return pos_ <= other.pos_;
+  }
+  bool operator>=(const RingConstIter &other) const {
+    return pos_ >= other.pos_;
+  }
+
+  size_t pos() const { return pos_; }
+
+private:
+  const _Storage *storage_;
+  size_t pos_;
+};
+
+// Storage over a preallocated circular array, items are kept contiguous and
+// stamps are duplicated in a packed array so that binary search only touches
+// stamps. The buffer doubles when full, so no allocation happens once it
+// reaches the steady state size of the history window.
+template <typename _Msg, typename _Alloc>
+struct RingStorage : public StorageBase<RingStorage<_Msg, _Alloc>> {
+  using Base = StorageBase<RingStorage<_Msg, _Alloc>>;
+  using MsgType = typename StorageTraits<RingStorage>::MsgType;
+  using ConstIter = typename StorageTraits<RingStorage>::ConstIter;
+  using Item = std::pair<Time, MsgType>;
+
+  using ItemAlloc =
+      typename std::allocator_traits<_Alloc>::template rebind_alloc<Item>;
+  using StampAlloc =
+      typename std::allocator_traits<_Alloc>::template rebind_alloc<Time>;
+
+  RingStorage(const Time history_win, const size_t capacity = 16)
+      : RingStorage(history_win, _Alloc(), capacity) {}
+
+  RingStorage(const Time history_win, const _Alloc &alloc,
+              const size_t capacity = 16)
+      : Base(history_win), items_(ItemAlloc(alloc)),
+        stamps_(StampAlloc(alloc)), head_(0), size_(0), base_(0), cursor_(0) {
+    size_t cap = 1;
+    while (cap < capacity) {
+      cap <<= 1;
+    }
+    items_.resize(cap);
+    stamps_.resize(cap);
+  }
+
+  // interface implementations
+
+  bool pushImpl(const Time &time, const MsgType &msg) {
+    return emplaceImpl(time, msg);
+  }
+
+  bool pushImpl(const Time &time, MsgType &&msg) {
+    return emplaceImpl(time, std::move(msg));
+  }
+
+  template <typename... _Args>
+  bool emplaceImpl(const Time &time, _Args &&...args) {
+    // check stamp monotonicity
+    if (size_ > 0 && time <= backStampImpl()) {
+      return false;
+    }
+
+    if (size_ == items_.size()) {
+      grow();
+    }
+
+    // seems everything ok, assign time msg pair to the tail slot
+    const size_t tail = phys(size_);
+    items_[tail].first = time;
+    if constexpr (sizeof...(_Args) == 1 &&
+                  (std::is_same_v<std::decay_t<_Args>, MsgType> && ...)) {
+      items_[tail].second = (std::forward<_Args>(args), ...);
+    } else {
+      items_[tail].second = MsgType(std::forward<_Args>(args)...);
+    }
+    stamps_[tail] = time;
+    ++size_;
+
+    // remove the old ones out of history window
+    evictBeforeImpl(this->windowStart(time));
+
+    return true;
+  }
+
+  void evictBeforeImpl(const Time time) {
+    while (size_ > 0 && frontStampImpl() < time) {
+      popFront();
+    }
+  }
+
+  size_t sizeImpl() const { return size_; }
+
+  bool emptyImpl() const { return size_ == 0; }
+
+  ConstIter beginImpl() const { return ConstIter(this, 0); }
+
+  ConstIter endImpl() const { return ConstIter(this, size_); }
+
+  ConstIter findImpl(const Time time) const {
+    const size_t pos = upperBound(time);
+    return pos > 0 && stamp(pos - 1) == time ? ConstIter(this, pos - 1)
+                                             : endImpl();
+  }
+
+  ConstIter findPreImpl(const Time time) const {
+    const size_t pos = upperBound(time);
+    return pos > 0 ? ConstIter(this, pos - 1) : endImpl();
+  }
+
+  ConstIter findSucImpl(const Time time) const {
+    return ConstIter(this, upperBound(time));
+  }
+
+  std::pair<Time, MsgType> frontImpl() const { return at(0); }
+
+  std::pair<Time, MsgType> backImpl() const { return at(size_ - 1); }
+
+  Time frontStampImpl() const { return stamp(0); }
+
+  Time backStampImpl() const { return stamp(size_ - 1); }
+
+  // item at logical position pos, counted from the front
+  const Item &at(const size_t pos) const { return items_[phys(pos)]; }
+
+  size_t capacity() const { return items_.size(); }
+
+protected:
+  size_t phys(const size_t pos) const {
+    return (head_ + pos) & (items_.size() - 1);
+  }
+
+  Time stamp(const size_t pos) const { return stamps_[phys(pos)]; }
+
+  // logical position of first item with stamp LARGE(>) than time, query
+  // times mostly move a few items at a time, so gallop from the cursor of
+  // the last query to bracket the result before binary search
+  size_t upperBound(const Time time) const {
+    const size_t pos =
+        cursor_ > base_ ? std::min(size_t(cursor_ - base_), size_) : 0;
+
+    size_t first = pos;
+    size_t last = pos;
+    if (pos < size_ && stamp(pos) <= time) {
+      size_t step = 1;
+      first = pos + 1;
+      last = first;
+      while (last < size_ && stamp(last) <= time) {
+        first = last + 1;
+        last = first + step;
+        step <<= 1;
+      }
+      last = std::min(last, size_);
+    } else if (pos > 0 && stamp(pos - 1) > time) {
+      size_t step = 1;
+      last = pos - 1;
+      first = last;
+      while (first > 0 && stamp(first - 1) > time) {
+        last = first - 1;
+        first = last > step ? last - step : 0;
+        step <<= 1;
+      }
+    }
+
+    first = upperBound(time, first, last);
+    cursor_ = base_ + first;
+    return first;
+  }
+
+  // binary search upper bound within logical position [first, last]
+  size_t upperBound(const Time time, size_t first, const size_t last) const {
+    size_t count = last - first;
+    while (count > 0) {
+      const size_t step = count / 2;
+      const size_t mid = first + step;
+      if (stamp(mid) <= time) {
+        first = mid + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+  void popFront() {
+    items_[head_] = Item();
+    head_ = phys(1);
+    --size_;
+    ++base_;
+  }
+
+  void grow() {
+    std::vector<Item, ItemAlloc> items(items_.size() * 2,
+                                       items_.get_allocator());
+    std::vector<Time, StampAlloc> stamps(stamps_.size() * 2,
+                                         stamps_.get_allocator());
+    for (size_t i = 0; i < size_; ++i) {
+      items[i] = std::move(items_[phys(i)]);
+      stamps[i] = stamps_[phys(i)];
+    }
+    items_.swap(items);
+    stamps_.swap(stamps);
+    head_ = 0;
+  }
+
+protected:
+  std::vector<Item, ItemAlloc> items_;
+  std::vector<Time, StampAlloc> stamps_;
+  size_t head_;
+  size_t size_;
+
+  // absolute index of the front item and of last query result, cursor
+  // survives eviction since it does not move with the front
+  uint64_t base_;
+  mutable uint64_t cursor_;
+};
+
+} // namespace msync
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "../storage.h"
+#include "../traits.h"
+#include "ring_storage.h"
+
+namespace msync {
+
+template <typename _Msg> struct SliceStorage;
+
+template <typename _Msg> struct StorageTraits<SliceStorage<_Msg>> {
+  using MsgType = _Msg;
+  using ConstIter = RingConstIter<SliceStorage<_Msg>>;
+};
+
+// Fixed capacity circular storage over slots it does not own, e.g. a slice
+// of an arena shared by many storages, see ArenaPolicyArray. It never
+// allocates, when full the oldest item is dropped for the new one and
+// counted, see overwrittenCount. It rejects pushes until bound to slots.
+template <typename _Msg>
+struct SliceStorage : public StorageBase<SliceStorage<_Msg>> {
+  using Base = StorageBase<SliceStorage<_Msg>>;
+  using MsgType = typename StorageTraits<SliceStorage>::MsgType;
+  using ConstIter = typename StorageTraits<SliceStorage>::ConstIter;
+  using Item = std::pair<Time, MsgType>;
+
+  SliceStorage(const Time history_win)
+      : Base(history_win), stamps_(nullptr), items_(nullptr), capacity_(0),
+        head_(0), size_(0), overwritten_(0) {}
+
+  // use capacity slots of stamps and items. if capacity is unchanged the
+  // items held are taken to be at the same slots of the new ones, e.g. a
+  // copy of the arena, otherwise storage is cleared
+  void bind(Time *stamps, Item *items, const size_t capacity) {
+    if (capacity != capacity_) {
+      capacity_ = capacity;
+      head_ = 0;
+      size_ = 0;
+    }
+    stamps_ = stamps;
+    items_ = items;
+  }
+
+  // interface implementations
+
+  bool pushImpl(const Time &time, const MsgType &msg) {
+    return emplaceImpl(time, msg);
+  }
+
+  bool pushImpl(const Time &time, MsgType &&msg) {
+    return emplaceImpl(time, std::move(msg));
+  }
+
+  template <typename... _Args>
+  bool emplaceImpl(const Time &time, _Args &&...args) {
+    // check stamp monotonicity
+    if (capacity_ == 0 || (size_ > 0 && time <= backStampImpl())) {
+      return false;
+    }
+
+    if (size_ == capacity_) {
+      popFront();
+      ++overwritten_;
+    }
+
+    // seems everything ok, assign time msg pair to the tail slot
+    const size_t tail = phys(size_);
+    items_[tail].first = time;
+    if constexpr (sizeof...(_Args) == 1 &&
+                  (std::is_same_v<std::decay_t<_Args>, MsgType> && ...)) {
+      items_[tail].second = (std::forward<_Args>(args), ...);
+    } else {
+      items_[tail].second = MsgType(std::forward<_Args>(args)...);
+    }
+    stamps_[tail] = time;
+    ++size_;
+
+    // remove the old ones out of history window
+    evictBeforeImpl(this->windowStart(time));
+
+    return true;
+  }
+
+  void evictBeforeImpl(const Time time) {
+    while (size_ > 0 && frontStampImpl() < time) {
+      popFront();
+    }
+  }
+
+  size_t sizeImpl() const { return size_; }
+
+  bool emptyImpl() const { return size_ == 0; }
+
+  ConstIter beginImpl() const { return ConstIter(this, 0); }
+
+  ConstIter endImpl() const { return ConstIter(this, size_); }
+
+  ConstIter findImpl(const Time time) const {
+    const size_t pos = upperBound(time);
+    return pos > 0 && stamp(pos - 1) == time ? ConstIter(this, pos - 1)
+                                             : endImpl();
+  }
+
+  ConstIter findPreImpl(const Time time) const {
+    const size_t pos = upperBound(time);
+    return pos > 0 ? ConstIter(this, pos - 1) : endImpl();
+  }
+
+  ConstIter findSucImpl(const Time time) const {
+    return ConstIter(this, upperBound(time));
+  }
+
+  std::pair<Time, MsgType> frontImpl() const { return at(0); }
+
+  std::pair<Time, MsgType> backImpl() const { return at(size_ - 1); }
+
+  Time frontStampImpl() const { return stamp(0); }
+
+  Time backStampImpl() const { return stamp(size_ - 1); }
+
+  // item at logical position pos, counted from the front
+  const Item &at(const size_t pos) const { return items_[phys(pos)]; }
+
+  size_t capacity() const { return capacity_; }
+
+  size_t overwrittenCountImpl() const { return overwritten_; }
+
+protected:
+  size_t phys(const size_t pos) const {
+    const size_t slot = head_ + pos;
+    return slot < capacity_ ? slot : slot - capacity_;
+  }
+
+  Time stamp(const size_t pos) const { return stamps_[phys(pos)]; }
+
+  // logical position of first item with stamp LARGE(>) than time, most
+  // queries are for the newest items, so check the back first
+  size_t upperBound(const Time time) const {
+    if (size_ == 0 || stamp(size_ - 1) <= time) {
+      return size_;
+    }
+    size_t first = 0;
+    size_t count = size_ - 1;
+    while (count > 0) {
+      const size_t step = count / 2;
+      const size_t mid = first + step;
+      if (stamp(mid) <= time) {
+        first = mid + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+  void popFront() {
+    items_[head_] = Item();
+    head_ = phys(1);
+    --size_;
+  }
+
+protected:
+  Time *stamps_;
+  Item *items_;
+  size_t capacity_;
+  size_t head_;
+  size_t size_;
+  size_t overwritten_;
+};
+
+} // namespace msync
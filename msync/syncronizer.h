@@ -1,10 +1,14 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <queue>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include "policy.h"
@@ -30,24 +34,115 @@ template <typename _Derived> struct SyncronizerBase {
   using PolicyOutType = typename PolicyTraits<Policy<_Idx>>::OutType;
 
   template <typename... _Polices>
-  SyncronizerBase(const PolicyAttribute attr, const _Polices &...policies)
-      : interest_attr_(attr), policies_(policies...) {
+  SyncronizerBase(const PolicyAttribute attr, const CallbackFunction &cb,
+                  const _Polices &...policies)
+      : interest_attr_(attr), policies_(policies...), cb_(cb),
+        now_(std::numeric_limits<Time>::lowest()) {
     time_pivot_ = -1;
+    suc_.fill(std::numeric_limits<Time>::lowest());
+    refreshSucHelper<kNumPolicies, true>();
   }
 
   template <size_t _Idx = 0>
   StatusCode push(const int64_t time, const PolicyInType<_Idx> &msg) {
     if (std::get<_Idx>(policies_).push(time, msg)) {
-      return checkQueue();
+      return pushed<_Idx>();
     } else {
+      MSYNC_STATS(stats_.pushed(false);)
       return kMsgDropped;
     }
   }
 
+  template <size_t _Idx = 0>
+  StatusCode push(const int64_t time, PolicyInType<_Idx> &&msg) {
+    if (std::get<_Idx>(policies_).push(time, std::move(msg))) {
+      return pushed<_Idx>();
+    } else {
+      MSYNC_STATS(stats_.pushed(false);)
+      return kMsgDropped;
+    }
+  }
+
+  // construct message in place, for PolicyArray the first arg is policy id
+  template <size_t _Idx = 0, typename... _Args>
+  StatusCode emplace(const int64_t time, _Args &&...args) {
+    auto &policy = std::get<_Idx>(policies_);
+    if (policy.emplace(time, std::forward<_Args>(args)...)) {
+      return pushed<_Idx>();
+    } else {
+      MSYNC_STATS(stats_.pushed(false);)
+      return kMsgDropped;
+    }
+  }
+
+  // push (time, msg) pairs in [first, last) to policy _Idx, return the
+  // number of accepted messages. each is matched as it is pushed, so a batch
+  // emits exactly as pushing one by one. items are moved out if iterators
+  // dereference to rvalue
+  template <size_t _Idx = 0, typename _Iter>
+  size_t pushBatch(_Iter first, const _Iter last) {
+    size_t accepted = 0;
+    for (; first != last; ++first) {
+      accepted += pushItem<_Idx>(*first);
+    }
+    return accepted;
+  }
+
+  // items of an rvalue range are moved out
+  template <size_t _Idx = 0, typename _Range>
+  size_t pushBatch(_Range &&items) {
+    auto [first, last] = batchCursor(std::forward<_Range>(items));
+    return pushBatch<_Idx>(first, last);
+  }
+
+  // push one range of (time, msg) pairs per policy, each sorted by stamp.
+  // they are merged by stamp, the lower policy on a tie, and pushed in that
+  // order, emitting exactly as pushing the merged streams one by one
+  template <typename... _Ranges> size_t pushBatches(_Ranges &&...items) {
+    static_assert(sizeof...(_Ranges) == kNumPolicies,
+                  "one range per policy is required");
+    auto cursors =
+        std::make_tuple(batchCursor(std::forward<_Ranges>(items))...);
+    size_t accepted = 0;
+    while (true) {
+      size_t idx = kNumPolicies;
+      Time time = std::numeric_limits<Time>::max();
+      earliestHeadHelper<kNumPolicies, true>(cursors, idx, time);
+      if (idx == kNumPolicies) {
+        break;
+      }
+      accepted += pushHeadHelper<kNumPolicies, true>(idx, cursors);
+    }
+    return accepted;
+  }
+
+  // only for assignable callback type, e.g. the default std::function
   void registerCallback(const CallbackFunction &cb) { cb_ = cb; }
 
   Time timePivot() const { return time_pivot_; }
 
+  MSYNC_STATS(SyncronizerStatsSnapshot stats() const {
+    return stats_.snapshot();
+  })
+
+  // stats of policy _Idx, for PolicyArray of its policy id
+  MSYNC_STATS(template <size_t _Idx = 0> PolicyStatsSnapshot policyStats()
+                  const { return std::get<_Idx>(policies_).stats(); })
+
+  MSYNC_STATS(template <size_t _Idx = 0> PolicyStatsSnapshot policyStats(
+                  int id) const { return std::get<_Idx>(policies_).stats(id); })
+
+  // tell syncronizer the time now, on the clock of stamps, so candidates
+  // waiting for policies longer than their max latency are emitted with
+  // optional messages flagged, or expire. messages policies hold back for
+  // reordering are released once now is reorder window past them. it never
+  // goes back
+  StatusCode tick(const Time now) {
+    now_ = std::max(now_, now);
+    releaseHelper<kNumPolicies, true>();
+    return derived().checkQueue();
+  }
+
   template <size_t _Idx = 0> size_t queueSize() const {
     return std::get<_Idx>(policies_).queueSize();
   }
@@ -56,47 +151,172 @@ template <typename _Derived> struct SyncronizerBase {
     return std::get<_Idx>(policies_).queueSize(id);
   }
 
+  // counters of policy _Idx, see Policy::setReorderWin
+  template <size_t _Idx = 0> size_t reorderedCount() const {
+    return std::get<_Idx>(policies_).reorderedCount();
+  }
+
+  template <size_t _Idx = 0> size_t reorderedCount(int id) const {
+    return std::get<_Idx>(policies_).reorderedCount(id);
+  }
+
+  template <size_t _Idx = 0> size_t droppedCount() const {
+    return std::get<_Idx>(policies_).droppedCount();
+  }
+
+  template <size_t _Idx = 0> size_t droppedCount(int id) const {
+    return std::get<_Idx>(policies_).droppedCount(id);
+  }
+
 protected:
-  virtual void updatePivot(const Time time, const StatusCode code) = 0;
+  // derived syncronizer must implement
+  //   void updatePivot(const Time time, const StatusCode code)
+  // or a checkQueue of its own, and may hide peekTime, or updateSuc if its
+  // checkQueue does not use the successor cache
+  Derived &derived() { return static_cast<Derived &>(*this); }
+  const Derived &derived() const { return static_cast<const Derived &>(*this); }
+
+  // time policy _Idx is peeked at for a candidate at time
+  template <size_t _Idx> Time peekTime(const Time time) const { return time; }
 
   StatusCode checkQueue() {
     Time time;
     StatusCode emit_status;
     bool any_emitted = false;
+    const Time last_pivot = time_pivot_;
 
     do {
-      time = sucTime(time_pivot_, interest_attr_);
+      time = sucTime();
       if (time == std::numeric_limits<Time>::max())
         break;
 
       emit_status = tryEmit(time);
-      updatePivot(time, emit_status);
+      MSYNC_STATS(stats_.tried(time, emit_status);)
+      derived().updatePivot(time, emit_status);
+      refreshSucHelper<kNumPolicies, true>();
 
       any_emitted |= (kEmitSuccess == emit_status);
     } while (emit_status > kEmitNotReady);
 
+    // messages before pivot will never be peeked again
+    if (time_pivot_ != last_pivot) {
+      evictHelper<kNumPolicies, true>(time_pivot_);
+    }
+
     return any_emitted ? kMsgEmitted : kMsgAccepted;
   }
 
-  Time sucTime(const Time time, const PolicyAttribute attr) const {
-    return sucTimeHelper<kNumPolicies, true>(time, attr);
+  // match after a message is accepted by policy _Idx
+  template <size_t _Idx> StatusCode pushed() {
+    MSYNC_STATS(stats_.pushed(true);)
+    derived().template updateSuc<_Idx>();
+    return derived().checkQueue();
+  }
+
+  // push a (time, msg) pair to policy _Idx, true if accepted
+  template <size_t _Idx, typename _Item> bool pushItem(_Item &&item) {
+    return kMsgDropped != push<_Idx>(std::forward<_Item>(item).first,
+                                     std::forward<_Item>(item).second);
+  }
+
+  // [begin, end) of items, move iterators if items is an rvalue
+  template <typename _Range> static auto batchCursor(_Range &&items) {
+    if constexpr (std::is_lvalue_reference_v<_Range>) {
+      return std::make_pair(std::begin(items), std::end(items));
+    } else {
+      return std::make_pair(std::make_move_iterator(std::begin(items)),
+                            std::make_move_iterator(std::end(items)));
+    }
+  }
+
+  // if _Idx != 0, earliestHeadHelper match this function
+  // idx and time of the earliest cursor head, the lower idx on a tie
+  template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>,
+            typename _Cursors>
+  static void earliestHeadHelper(const _Cursors &cursors, size_t &idx,
+                                 Time &time) {
+    const auto &[first, last] = std::get<_Idx - 1>(cursors);
+    if (first != last && (*first).first <= time) {
+      idx = _Idx - 1;
+      time = (*first).first;
+    }
+    earliestHeadHelper<_Idx - 1, true>(cursors, idx, time);
+  }
+
+  // if _Idx == 0, earliestHeadHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>,
+            typename _Cursors>
+  static void earliestHeadHelper(const _Cursors &, size_t &, Time &) {}
+
+  // if _Idx != 0, pushHeadHelper match this function
+  // push the head of cursor idx and move it forward
+  template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>,
+            typename _Cursors>
+  bool pushHeadHelper(const size_t idx, _Cursors &cursors) {
+    if (idx != _Idx - 1) {
+      return pushHeadHelper<_Idx - 1, true>(idx, cursors);
+    }
+    auto &first = std::get<_Idx - 1>(cursors).first;
+    const bool ok = pushItem<_Idx - 1>(*first);
+    ++first;
+    return ok;
+  }
+
+  // if _Idx == 0, pushHeadHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>,
+            typename _Cursors>
+  bool pushHeadHelper(const size_t, _Cursors &) {
+    return false;
+  }
+
+  // min successor of pivot over policies, each one is cached in suc_
+  Time sucTime() const { return *std::min_element(suc_.begin(), suc_.end()); }
+
+  // cache the successor of pivot of policy _Idx
+  template <size_t _Idx> void updateSuc() {
+    const auto &policy = std::get<_Idx>(policies_);
+    suc_[_Idx] = policy.sucTime(time_pivot_, interest_attr_);
   }
 
-  // if _Idx != 0, sucTimeHelper match this function
+  // if _Idx != 0, refreshSucHelper match this function
+  // only successors passed by pivot need update
   template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>>
-  Time sucTimeHelper(const Time time, const PolicyAttribute attr) const {
-    const auto &policy = std::get<_Idx - 1>(policies_);
+  void refreshSucHelper() {
+    if (suc_[_Idx - 1] <= time_pivot_) {
+      updateSuc<_Idx - 1>();
+    }
+    refreshSucHelper<_Idx - 1, true>();
+  }
+
+  // if _Idx == 0, refreshSucHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>>
+  void refreshSucHelper() {}
 
-    return std::min(policy.sucTime(time, attr),
-                    sucTimeHelper<_Idx - 1, true>(time, attr));
+  // if _Idx != 0, releaseHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>>
+  void releaseHelper() {
+    if (std::get<_Idx - 1>(policies_).releaseHeld(now_)) {
+      derived().template updateSuc<_Idx - 1>();
+    }
+    releaseHelper<_Idx - 1, true>();
   }
 
-  // if _Idx == 0, findNearestSuc match this function
+  // if _Idx == 0, releaseHelper match this function
   template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>>
-  Time sucTimeHelper(const Time, const PolicyAttribute) const {
-    return std::numeric_limits<Time>::max();
+  void releaseHelper() {}
+
+  // if _Idx != 0, evictHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>>
+  void evictHelper(const Time time) {
+    std::get<_Idx - 1>(policies_).evictBefore(
+        derived().template peekTime<_Idx - 1>(time));
+    evictHelper<_Idx - 1, true>(time);
   }
 
+  // if _Idx == 0, evictHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>>
+  void evictHelper(const Time) {}
+
   StatusCode tryEmit(const Time time) {
     return emitHelper<kNumPolicies, true>(time);
   }
@@ -106,11 +326,20 @@ protected:
             typename... _Msgs>
   StatusCode emitHelper(const int64_t time, const _Msgs &...msgs) {
     const auto &policy = std::get<_Idx - 1>(policies_);
-    const auto &[msg, status] = policy.peek(time);
+    const auto &[msg, status] =
+        policy.peek(derived().template peekTime<_Idx - 1>(time));
 
     if (kPeekSuccess == status) {
       return emitHelper<_Idx - 1, true>(time, msg, msgs...);
-    } else if (kPeekExpired == status) {
+    }
+
+    // expired, or not ready for max latency, optional policy is then
+    // flagged instead of failing the candidate, a required one expires it
+    const bool timeout = kPeekExpired == status ||
+                         (now_ > time && now_ - time >= policy.maxLatency());
+    if (timeout && kOptional == policy.attr()) {
+      return emitHelper<_Idx - 1, true>(time, msg, msgs...);
+    } else if (timeout) {
       return kEmitExpired;
     } else {
       return kEmitNotReady;
@@ -121,45 +350,77 @@ protected:
   template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool> _,
             typename... _Msgs>
   StatusCode emitHelper(const int64_t time, const _Msgs &...msgs) {
-    if (cb_)
+    MSYNC_STATS(const auto from = SyncronizerStats::Clock::now();)
+    if (callable(cb_))
       cb_(time, msgs...);
+    MSYNC_STATS(stats_.called(from);)
     return kEmitSuccess;
   }
 
+  // std::function and function pointer may be empty, other invocable not
+  template <typename _Callback> static bool callable(const _Callback &cb) {
+    if constexpr (std::is_constructible_v<bool, const _Callback &>) {
+      return static_cast<bool>(cb);
+    } else {
+      return true;
+    }
+  }
+
 protected:
   Time time_pivot_;
   PolicyAttribute interest_attr_;
   PolicyTuple policies_;
   CallbackFunction cb_;
-};
+  std::array<Time, kNumPolicies> suc_;
 
-template <typename... _Polices> struct SyncronizerMinInterval;
+  // last time given to tick
+  Time now_;
 
+  // see stats.h
+  MSYNC_STATS(SyncronizerStats stats_;)
+};
+
+// default callback type of syncronizer over _Polices
 template <typename... _Polices>
-struct SyncronizerTraits<SyncronizerMinInterval<_Polices...>> {
+using SyncronizerCallback = std::function<void(
+    const int64_t time,
+    const typename PolicyTraits<_Polices>::OutType &...msgs)>;
+
+template <typename _Callback, typename... _Polices>
+struct BasicSyncronizerMinInterval;
+
+template <typename _Callback, typename... _Polices>
+struct SyncronizerTraits<BasicSyncronizerMinInterval<_Callback, _Polices...>> {
   using PolicyTuple = std::tuple<_Polices...>;
 
-  using CallbackFunction = std::function<void(
-      const int64_t time,
-      const typename PolicyTraits<_Polices>::OutType &...msgs)>;
+  using CallbackFunction = _Callback;
 };
 
-template <typename... _Polices>
-struct SyncronizerMinInterval
-    : public SyncronizerBase<SyncronizerMinInterval<_Polices...>> {
-  using Base = SyncronizerBase<SyncronizerMinInterval<_Polices...>>;
+template <typename _Callback, typename... _Polices>
+struct BasicSyncronizerMinInterval
+    : public SyncronizerBase<
+          BasicSyncronizerMinInterval<_Callback, _Polices...>> {
+  using Base =
+      SyncronizerBase<BasicSyncronizerMinInterval<_Callback, _Polices...>>;
 
   using Base::kNumPolicies;
   using Base::policies_;
   using Base::time_pivot_;
 
+  friend Base;
+
   // constructor
-  SyncronizerMinInterval(const int64_t min_interval,
-                         const _Polices &...policies)
-      : Base(kNormal, policies...), min_interval_(min_interval) {}
+  BasicSyncronizerMinInterval(const int64_t min_interval,
+                              const _Polices &...policies)
+      : Base(kNormal, _Callback(), policies...), min_interval_(min_interval) {}
+
+  // constructor with callback
+  BasicSyncronizerMinInterval(const int64_t min_interval, const _Callback &cb,
+                              const _Polices &...policies)
+      : Base(kNormal, cb, policies...), min_interval_(min_interval) {}
 
 protected:
-  virtual void updatePivot(const Time time, const StatusCode code) override {
+  void updatePivot(const Time time, const StatusCode code) {
     if (code == kEmitSuccess) {
       time_pivot_ = time + min_interval_ - 1;
     } else if (code == kEmitExpired) {
@@ -171,38 +432,341 @@ protected:
   Time min_interval_;
 };
 
-template <typename... _Polices> struct SyncronizerMasterSlave;
-
 template <typename... _Polices>
-struct SyncronizerTraits<SyncronizerMasterSlave<_Polices...>> {
+using SyncronizerMinInterval =
+    BasicSyncronizerMinInterval<SyncronizerCallback<_Polices...>, _Polices...>;
+
+// make min interval syncronizer calling cb without type erasure
+template <typename _Callback, typename... _Polices>
+BasicSyncronizerMinInterval<_Callback, _Polices...>
+makeSyncronizerMinInterval(const int64_t min_interval, const _Callback &cb,
+                           const _Polices &...policies) {
+  return {min_interval, cb, policies...};
+}
+
+template <typename _Callback, typename... _Polices>
+struct BasicSyncronizerMasterSlave;
+
+template <typename _Callback, typename... _Polices>
+struct SyncronizerTraits<BasicSyncronizerMasterSlave<_Callback, _Polices...>> {
   using PolicyTuple = std::tuple<_Polices...>;
 
-  using CallbackFunction = std::function<void(
-      const int64_t time,
-      const typename PolicyTraits<_Polices>::OutType &...msgs)>;
+  using CallbackFunction = _Callback;
 };
 
-template <typename... _Polices>
-struct SyncronizerMasterSlave
-    : public SyncronizerBase<SyncronizerMasterSlave<_Polices...>> {
-  using Base = SyncronizerBase<SyncronizerMasterSlave<_Polices...>>;
+template <typename _Callback, typename... _Polices>
+struct BasicSyncronizerMasterSlave
+    : public SyncronizerBase<
+          BasicSyncronizerMasterSlave<_Callback, _Polices...>> {
+  using Base =
+      SyncronizerBase<BasicSyncronizerMasterSlave<_Callback, _Polices...>>;
 
   using Base::kNumPolicies;
   using Base::policies_;
   using Base::time_pivot_;
 
+  friend Base;
+
   // constructor
-  SyncronizerMasterSlave(const _Polices &...policies)
-      : Base(kMaster, policies...) {}
+  BasicSyncronizerMasterSlave(const _Polices &...policies)
+      : Base(kMaster, _Callback(), policies...) {}
+
+  // constructor with callback
+  BasicSyncronizerMasterSlave(const _Callback &cb, const _Polices &...policies)
+      : Base(kMaster, cb, policies...) {}
 
 protected:
-  virtual void updatePivot(const Time time, const StatusCode code) override {
+  void updatePivot(const Time time, const StatusCode code) {
     if (code > kEmitNotReady) {
       time_pivot_ = time;
     }
   }
 };
 
+template <typename... _Polices>
+using SyncronizerMasterSlave =
+    BasicSyncronizerMasterSlave<SyncronizerCallback<_Polices...>, _Polices...>;
+
+// make master slave syncronizer calling cb without type erasure
+template <typename _Callback, typename... _Polices>
+BasicSyncronizerMasterSlave<_Callback, _Polices...>
+makeSyncronizerMasterSlave(const _Callback &cb, const _Polices &...policies) {
+  return {cb, policies...};
+}
+
+template <typename _Callback, typename... _Polices>
+struct BasicSyncronizerApproximateTime;
+
+template <typename _Callback, typename... _Polices>
+struct SyncronizerTraits<
+    BasicSyncronizerApproximateTime<_Callback, _Polices...>> {
+  using PolicyTuple = std::tuple<_Polices...>;
+
+  using CallbackFunction = _Callback;
+};
+
+// Approximate time syncronizer, like ApproximateTime of ros message_filters.
+// It emits sets of one message per policy, each set has the smallest stamp
+// spread among sets containing its pivot, the message ending the first set
+// found after the last emission. Each policy keeps a cursor (head) on its
+// storage, the search moves the earliest head forward and keeps the best
+// candidate, it emits once the pivot is passed or no later set could beat
+// the candidate, where inter message lower bounds help deciding before the
+// next message arrives. All policies are required, each is peeked at the
+// stamp of its own message, callback is given the largest stamp of the set.
+template <typename _Callback, typename... _Polices>
+struct BasicSyncronizerApproximateTime
+    : public SyncronizerBase<
+          BasicSyncronizerApproximateTime<_Callback, _Polices...>> {
+  using Base =
+      SyncronizerBase<BasicSyncronizerApproximateTime<_Callback, _Polices...>>;
+
+  using Base::kNumPolicies;
+  using Base::now_;
+  using Base::policies_;
+  using Base::time_pivot_;
+
+  friend Base;
+
+  // constructor
+  BasicSyncronizerApproximateTime(const _Polices &...policies)
+      : Base(kOptional, _Callback(), policies...) {
+    init();
+  }
+
+  // constructor with callback
+  BasicSyncronizerApproximateTime(const _Callback &cb,
+                                  const _Polices &...policies)
+      : Base(kOptional, cb, policies...) {
+    init();
+  }
+
+  // sets spanning LARGE(>) than max_interval are never emitted
+  void setMaxInterval(const Time max_interval) { max_interval_ = max_interval; }
+
+  // stamps of policy idx are at least bound apart
+  void setInterMessageLowerBound(const size_t idx, const Time bound) {
+    lower_bound_.at(idx) = bound;
+  }
+
+protected:
+  using Stamps = std::array<Time, kNumPolicies>;
+
+  static constexpr Time kNone = std::numeric_limits<Time>::max();
+
+  void init() {
+    max_interval_ = kNone;
+    lower_bound_.fill(0);
+    head_.fill(kNone);
+    last_.fill(std::numeric_limits<Time>::lowest());
+    cand_.fill(0);
+    pivot_ = kNumPolicies;
+    pivot_time_ = 0;
+    cand_start_ = 0;
+    cand_end_ = 0;
+  }
+
+  StatusCode checkQueue() {
+    bool any_emitted = false;
+
+    // heads of exhausted policies may have got new messages
+    for (size_t i = 0; i < kNumPolicies; ++i) {
+      if (head_[i] == kNone) {
+        head_[i] = next(i, last_[i]);
+      }
+    }
+
+    while (true) {
+      while (allHeads()) {
+        const auto [start_idx, start_time] = earliest(head_);
+        const auto [end_idx, end_time] = latest(head_);
+
+        if (pivot_ == kNumPolicies) {
+          if (end_time - start_time > max_interval_) {
+            move(start_idx);
+            continue;
+          }
+          pivot_ = end_idx;
+          pivot_time_ = end_time;
+          makeCandidate(start_time, end_time);
+        } else if (end_time - cand_end_ < start_time - cand_start_) {
+          makeCandidate(start_time, end_time);
+        }
+        move(start_idx);
+
+        if (start_idx == pivot_ ||
+            end_time - cand_end_ >= pivot_time_ - cand_start_) {
+          // pivot passed, or later sets span no less than candidate
+          any_emitted |= publish();
+        }
+      }
+
+      // exhausted policies may be proven unable to beat the candidate
+      if (pivot_ == kNumPolicies || !virtualSearch()) {
+        break;
+      }
+      any_emitted |= publish();
+    }
+
+    return any_emitted ? kMsgEmitted : kMsgAccepted;
+  }
+
+  // go on searching as if exhausted policies had messages at the earliest
+  // stamps their lower bounds and the clock given to tick allow, true if
+  // candidate is proven the best,
+  // heads are restored otherwise
+  bool virtualSearch() {
+    const Stamps head = head_;
+    const Stamps last = last_;
+
+    while (true) {
+      Stamps stamps;
+      for (size_t i = 0; i < kNumPolicies; ++i) {
+        stamps[i] = head_[i] != kNone
+                        ? head_[i]
+                        : std::max({last_[i] + lower_bound_[i], pivot_time_,
+                                    clockBound(i)});
+      }
+      const auto [start_idx, start_time] = earliest(stamps);
+      const auto [end_idx, end_time] = latest(stamps);
+
+      if (end_time - cand_end_ >= pivot_time_ - cand_start_) {
+        return true;
+      }
+      if (end_time - cand_end_ < start_time - cand_start_ ||
+          head_[start_idx] == kNone) {
+        // a better set may come, wait for more messages
+        head_ = head;
+        last_ = last;
+        return false;
+      }
+      move(start_idx);
+    }
+  }
+
+  bool publish() {
+    time_pivot_ = cand_end_;
+    const StatusCode status = Base::tryEmit(cand_end_);
+    MSYNC_STATS(this->stats_.tried(cand_end_, status);)
+    Base::template evictHelper<kNumPolicies, true>(cand_end_);
+
+    for (size_t i = 0; i < kNumPolicies; ++i) {
+      last_[i] = cand_[i];
+      head_[i] = next(i, cand_[i]);
+    }
+    pivot_ = kNumPolicies;
+
+    return kEmitSuccess == status;
+  }
+
+  void makeCandidate(const Time start_time, const Time end_time) {
+    cand_ = head_;
+    cand_start_ = start_time;
+    cand_end_ = end_time;
+  }
+
+  // move head of policy idx to its next message
+  void move(const size_t idx) {
+    last_[idx] = head_[idx];
+    head_[idx] = next(idx, head_[idx]);
+  }
+
+  bool allHeads() const {
+    return std::find(head_.begin(), head_.end(), kNone) == head_.end();
+  }
+
+  static std::pair<size_t, Time> earliest(const Stamps &stamps) {
+    const auto iter = std::min_element(stamps.begin(), stamps.end());
+    return {size_t(iter - stamps.begin()), *iter};
+  }
+
+  static std::pair<size_t, Time> latest(const Stamps &stamps) {
+    const auto iter = std::max_element(stamps.begin(), stamps.end());
+    return {size_t(iter - stamps.begin()), *iter};
+  }
+
+  // earliest stamp policy idx could still get, as no message arrives later
+  // than max latency of its policy on the clock given to tick
+  Time clockBound(const size_t idx) const {
+    const Time latency = maxLatencyHelper<kNumPolicies, true>(idx);
+    if (now_ < std::numeric_limits<Time>::lowest() + latency) {
+      return std::numeric_limits<Time>::lowest();
+    }
+    return now_ - latency;
+  }
+
+  // if _Idx != 0, maxLatencyHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>>
+  Time maxLatencyHelper(const size_t idx) const {
+    if (idx == _Idx - 1) {
+      return std::get<_Idx - 1>(policies_).maxLatency();
+    }
+    return maxLatencyHelper<_Idx - 1, true>(idx);
+  }
+
+  // if _Idx == 0, maxLatencyHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>>
+  Time maxLatencyHelper(const size_t) const {
+    return std::numeric_limits<Time>::max();
+  }
+
+  // first stamp LARGE(>) than time of policy idx, kNone if none
+  Time next(const size_t idx, const Time time) const {
+    return nextHelper<kNumPolicies, true>(idx, time);
+  }
+
+  // if _Idx != 0, nextHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx != 0, bool>>
+  Time nextHelper(const size_t idx, const Time time) const {
+    if (idx == _Idx - 1) {
+      return std::get<_Idx - 1>(policies_).sucTime(time, kOptional);
+    }
+    return nextHelper<_Idx - 1, true>(idx, time);
+  }
+
+  // if _Idx == 0, nextHelper match this function
+  template <size_t _Idx, typename std::enable_if_t<_Idx == 0, bool>>
+  Time nextHelper(const size_t, const Time) const {
+    return kNone;
+  }
+
+  template <size_t _Idx> Time peekTime(const Time) const {
+    return cand_[_Idx];
+  }
+
+  // heads are searched on storages, the successor cache of Base is unused
+  template <size_t _Idx> void updateSuc() {}
+
+protected:
+  Time max_interval_;
+  Stamps lower_bound_;
+
+  // stamp of the first message not yet searched of each policy, and of the
+  // one before it
+  Stamps head_;
+  Stamps last_;
+
+  // best set found for current pivot
+  Stamps cand_;
+  size_t pivot_;
+  Time pivot_time_;
+  Time cand_start_;
+  Time cand_end_;
+};
+
+template <typename... _Polices>
+using SyncronizerApproximateTime =
+    BasicSyncronizerApproximateTime<SyncronizerCallback<_Polices...>,
+                                    _Polices...>;
+
+// make approximate time syncronizer calling cb without type erasure
+template <typename _Callback, typename... _Polices>
+BasicSyncronizerApproximateTime<_Callback, _Polices...>
+makeSyncronizerApproximateTime(const _Callback &cb,
+                               const _Polices &...policies) {
+  return {cb, policies...};
+}
+
 template <typename _Policy>
 using HomoSyncronizerMinInterval = SyncronizerMinInterval<PolicyArray<_Policy>>;
 
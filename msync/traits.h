@@ -1,5 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "types.h"
+
 namespace msync {
 
 template <typename _T> struct PolicyTraits {};
@@ -8,10 +15,107 @@ template <typename _T> struct StorageTraits {};
 
 template <typename _T> struct SyncronizerTraits {};
 
+// out type of non-interpolating policies, given peek mode
+template <typename _Msg, PeekMode _Mode> struct PeekOutTraits {};
+
+template <typename _Msg> struct PeekOutTraits<_Msg, kPeekCopy> {
+  using OutType = std::pair<_Msg, bool>;
+  static OutType some(const _Msg &msg) { return {msg, true}; }
+  static OutType none() { return {_Msg{}, false}; }
+};
+
+template <typename _Msg> struct PeekOutTraits<_Msg, kPeekRef> {
+  using OutType = std::pair<const _Msg *, bool>;
+  static OutType some(const _Msg &msg) { return {&msg, true}; }
+  static OutType none() { return {nullptr, false}; }
+};
+
+// true unless StorageTraits of storage sets kStableItems false, i.e. an
+// item it hands out may move before the next push, so kPeekRef can not
+// point into it
+template <typename _Storage, typename = void>
+struct StableItems : std::true_type {};
+
+template <typename _Storage>
+struct StableItems<_Storage,
+                   std::void_t<decltype(StorageTraits<_Storage>::kStableItems)>>
+    : std::bool_constant<StorageTraits<_Storage>::kStableItems> {};
+
+// default serializer traits of record/replay, raw bytes of trivially
+// copyable message
+template <typename T> struct SerializerTraits {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "message needs a specialization of SerializerTraits");
+
+  static size_t size(const T &) { return sizeof(T); }
+  static void serialize(const T &msg, char *out) {
+    std::memcpy(out, &msg, sizeof(T));
+  }
+  static bool deserialize(const char *in, const size_t size, T &msg) {
+    if (size != sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&msg, in, sizeof(T));
+    return true;
+  }
+};
+
+// serializer traits of pair, e.g. InType of PolicyArray, size of first
+// goes ahead of it
+template <typename A, typename B> struct SerializerTraits<std::pair<A, B>> {
+  using T = std::pair<A, B>;
+
+  static size_t size(const T &msg) {
+    return sizeof(uint32_t) + SerializerTraits<A>::size(msg.first) +
+           SerializerTraits<B>::size(msg.second);
+  }
+  static void serialize(const T &msg, char *out) {
+    const uint32_t first_size = SerializerTraits<A>::size(msg.first);
+    std::memcpy(out, &first_size, sizeof(first_size));
+    SerializerTraits<A>::serialize(msg.first, out + sizeof(first_size));
+    SerializerTraits<B>::serialize(msg.second,
+                                   out + sizeof(first_size) + first_size);
+  }
+  static bool deserialize(const char *in, const size_t size, T &msg) {
+    uint32_t first_size;
+    if (size < sizeof(first_size)) {
+      return false;
+    }
+    std::memcpy(&first_size, in, sizeof(first_size));
+    if (size - sizeof(first_size) < first_size) {
+      return false;
+    }
+    in += sizeof(first_size);
+    return SerializerTraits<A>::deserialize(in, first_size, msg.first) &&
+           SerializerTraits<B>::deserialize(
+               in + first_size, size - sizeof(first_size) - first_size,
+               msg.second);
+  }
+};
+
 // default linear interpolater traits
 template <typename T> struct LinearInterpolaterTraits {
   static T plus(const T &a, const T &b) { return a + b; }
   static T between(const T &from, const T &to) { return to - from; }
 };
 
+// interpolater traits trading accuracy for speed, same as linear
+// interpolater traits unless specialized
+template <typename T>
+struct FastInterpolaterTraits : public LinearInterpolaterTraits<T> {};
+
+// default batch interpolater traits, out[i] = plus(from, tangent * ratio[i])
+// for i in [0, n), one plus of _Interpolater at a time. specialize it for a
+// kernel sharing work between ratios of one segment
+template <typename T, typename _Interpolater = LinearInterpolaterTraits<T>>
+struct BatchInterpolaterTraits {
+  template <typename _Tangent>
+  static void plus(const T &from, const _Tangent &tangent,
+                   const double *ratios, const size_t n, T *out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = _Interpolater::plus(from, tangent * ratios[i]);
+    }
+  }
+};
+
 } // namespace msync
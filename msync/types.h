@@ -11,6 +11,20 @@ enum PolicyAttribute {
   kMaster,       // Master policy
 };
 
+// how a non-interpolating policy hands peeked messages out
+enum PeekMode {
+  kPeekCopy = 0, // message is copied out, OutType is pair<Msg, bool>
+  kPeekRef,      // pointer into storage, OutType is pair<const Msg *, bool>,
+                 // it is valid until the next push to the same policy
+};
+
+// what a bounded dispatch queue does when it is full
+enum OverflowPolicy {
+  kOverflowBlock = 0,  // block the emitting thread until there is room
+  kOverflowDropOldest, // drop the oldest queued emission
+  kOverflowDropNewest, // drop the emission being posted
+};
+
 enum StatusCode {
   kMsgDropped = 0,
   kMsgAccepted,
@@ -23,6 +37,10 @@ enum StatusCode {
   kEmitNotReady = 20,
   kEmitExpired,
   kEmitSuccess,
+
+  kDispatchAccepted = 30,
+  kDispatchReplaced, // accepted, the oldest queued one is dropped for it
+  kDispatchDropped,
 };
 
 } // namespace msync
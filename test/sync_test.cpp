@@ -1,19 +1,90 @@
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <numeric>
+#include <thread>
+
 #include "eigen3/Eigen/Core"
 #include "eigen3/Eigen/Geometry"
 
+#include "msync/arena_policy_array.h"
+#include "msync/async_dispatcher.h"
+#include "msync/concurrent_syncronizer.h"
+#include "msync/record.h"
+#include "msync/supported_allocators/arena_allocator.h"
+#include "msync/supported_allocators/pool_allocator.h"
 #include "msync/supported_messages/eigen_quaternion.h"
 #include "msync/supported_messages/eigen_se3.h"
+#include "msync/supported_policies/cubic_interpolater.h"
 #include "msync/supported_policies/exact_time.h"
 #include "msync/supported_policies/linear_interpolater.h"
 #include "msync/supported_policies/nearest.h"
 #include "msync/supported_policies/newest.h"
 #include "msync/supported_storages/map_storage.h"
+#include "msync/supported_storages/mapped_storage.h"
+#include "msync/supported_storages/ring_storage.h"
+#include "msync/supported_storages/slice_storage.h"
 #include "msync/syncronizer.h"
 
 using namespace msync;
 
+// message which counts how many times it is copied
+struct CopyCounter {
+  static int copies;
+
+  CopyCounter() : value(0) {}
+  CopyCounter(const int v) : value(v) {}
+  CopyCounter(const int a, const int b) : value(a + b) {}
+  CopyCounter(const CopyCounter &other) : value(other.value) { ++copies; }
+  CopyCounter(CopyCounter &&other) = default;
+  CopyCounter &operator=(const CopyCounter &other) {
+    value = other.value;
+    ++copies;
+    return *this;
+  }
+  CopyCounter &operator=(CopyCounter &&other) = default;
+
+  int value;
+};
+
+int CopyCounter::copies = 0;
+
+// message which counts how many times a tangent is computed between two
+struct BetweenCounter {
+  static int betweens;
+
+  double value;
+};
+
+int BetweenCounter::betweens = 0;
+
+namespace msync {
+template <> struct LinearInterpolaterTraits<BetweenCounter> {
+  static BetweenCounter plus(const BetweenCounter &a, const double b) {
+    return {a.value + b};
+  }
+  static double between(const BetweenCounter &from, const BetweenCounter &to) {
+    ++BetweenCounter::betweens;
+    return to.value - from.value;
+  }
+};
+} // namespace msync
+
+// message claiming a payload too large for the uint32 size of a record
+struct OversizedPayload {};
+
+namespace msync {
+template <> struct SerializerTraits<OversizedPayload> {
+  static size_t size(const OversizedPayload &) {
+    return size_t(UINT32_MAX) + 1;
+  }
+  static void serialize(const OversizedPayload &, char *) { ADD_FAILURE(); }
+  static bool deserialize(const char *, const size_t, OversizedPayload &) {
+    return false;
+  }
+};
+} // namespace msync
+
 TEST(InterfaceTest, Syncronizer) {
   using Vector3f = Eigen::Vector3f;
   using Msg = Vector3f;
@@ -202,6 +273,1959 @@ TEST(InterfaceTest, QeueuSize) {
   }
 }
 
+TEST(StorageTest, Ring) {
+  using Msg = int;
+
+  {
+    RingStorage<Msg> ring(100, 2);
+    MapStorage<Msg> map(100);
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_TRUE(ring.findPre(0) == ring.end());
+    EXPECT_TRUE(ring.findSuc(0) == ring.end());
+
+    for (Time t = 0; t < 300; t += 3) {
+      EXPECT_EQ(ring.push(t, int(t)), map.push(t, int(t)));
+      EXPECT_EQ(ring.size(), map.size());
+      EXPECT_EQ(ring.frontStamp(), map.frontStamp());
+      EXPECT_EQ(ring.backStamp(), map.backStamp());
+
+      for (Time q = ring.frontStamp() - 2; q <= t + 2; ++q) {
+        auto r_found = ring.find(q);
+        auto m_found = map.find(q);
+        EXPECT_EQ(r_found == ring.end(), m_found == map.end());
+        if (r_found != ring.end()) {
+          EXPECT_EQ(r_found->first, m_found->first);
+          EXPECT_EQ(r_found->second, m_found->second);
+        }
+
+        auto r_pre = ring.findPre(q);
+        auto m_pre = map.findPre(q);
+        EXPECT_EQ(r_pre == ring.end(), m_pre == map.end());
+        if (r_pre != ring.end()) {
+          EXPECT_EQ(r_pre->first, m_pre->first);
+        }
+
+        auto r_suc = ring.findSuc(q);
+        auto m_suc = map.findSuc(q);
+        EXPECT_EQ(r_suc == ring.end(), m_suc == map.end());
+        if (r_suc != ring.end()) {
+          EXPECT_EQ(r_suc->first, m_suc->first);
+        }
+      }
+    }
+
+    // stamp must be strictly increasing
+    EXPECT_FALSE(ring.push(ring.backStamp(), 0));
+  }
+
+  { // capacity stays once the history window is filled
+    RingStorage<Msg> ring(10, 4);
+    for (Time t = 0; t < 1000; ++t) {
+      ring.push(t, 0);
+    }
+    EXPECT_EQ(ring.size(), 11);
+    EXPECT_EQ(ring.capacity(), 16);
+    EXPECT_EQ(std::prev(ring.end())->first, 999);
+    EXPECT_EQ(ring.begin()->first, 989);
+  }
+
+  { // every policy could use it
+    using Storage = RingStorage<Msg>;
+    using Alloc = std::allocator<std::pair<const Time, Msg>>;
+    using P0 = ExactTimePolicy<Msg, Alloc, Storage>;
+    using P1 = LinearInterpolatePolicy<Msg, Alloc, Storage>;
+    using P2 = NearestPolicy<Msg, Alloc, Storage>;
+    using P3 = NewestPolicy<Msg, Alloc, Storage>;
+    using Sync = SyncronizerMasterSlave<P0, P1, P2, P3>;
+
+    std::vector<Time> emit_times;
+    Sync sync(P0(100, kMaster), P1(100, 0), P2(100, 10), P3(100));
+    sync.registerCallback([&](const Time time, const std::pair<Msg, bool> &,
+                              const std::pair<Msg, bool> &p1,
+                              const std::pair<Msg, bool> &p2,
+                              const std::pair<Msg, bool> &) {
+      EXPECT_EQ(p1.first, time);
+      EXPECT_EQ(p2.first, 10);
+      emit_times.emplace_back(time);
+    });
+
+    sync.push<0>(4, 0);
+    sync.push<0>(5, 0);
+    sync.push<1>(0, 0);
+    sync.push<2>(10, 10);
+    sync.push<3>(0, 0);
+    EXPECT_EQ(sync.push<1>(10, 10), StatusCode::kMsgEmitted);
+    EXPECT_EQ(emit_times, (std::vector<Time>{4, 5}));
+  }
+}
+
+TEST(StorageTest, Mapped) {
+  using Msg = int;
+
+  { // same as map storage, across pages, compaction and page reads
+    MappedStorage<Msg> mapped(1000);
+    MapStorage<Msg> map(1000);
+    EXPECT_TRUE(mapped.ok());
+    EXPECT_TRUE(mapped.empty());
+    EXPECT_TRUE(mapped.findPre(0) == mapped.end());
+
+    for (Time t = 0; t < 6000; t += 2) {
+      EXPECT_EQ(mapped.push(t, int(t)), map.push(t, int(t)));
+      EXPECT_EQ(mapped.size(), map.size());
+      EXPECT_EQ(mapped.frontStamp(), map.frontStamp());
+      EXPECT_EQ(mapped.backStamp(), map.backStamp());
+
+      if (t % 250 != 0) {
+        continue;
+      }
+      for (Time q = mapped.frontStamp() - 1; q <= t + 1; q += 7) {
+        auto m_found = map.find(q);
+        auto found = mapped.find(q);
+        EXPECT_EQ(found == mapped.end(), m_found == map.end());
+        if (found != mapped.end()) {
+          EXPECT_EQ(found->second, m_found->second);
+        }
+
+        auto m_pre = map.findPre(q);
+        auto pre = mapped.findPre(q);
+        EXPECT_EQ(pre == mapped.end(), m_pre == map.end());
+        if (pre != mapped.end()) {
+          EXPECT_EQ(pre->first, m_pre->first);
+          EXPECT_EQ(pre->second, m_pre->second);
+        }
+
+        auto m_suc = map.findSuc(q);
+        auto suc = mapped.findSuc(q);
+        EXPECT_EQ(suc == mapped.end(), m_suc == map.end());
+        if (suc != mapped.end()) {
+          EXPECT_EQ(suc->second, m_suc->second);
+        }
+      }
+    }
+    EXPECT_GT(mapped.pageReadCount(), 0);
+    EXPECT_FALSE(mapped.push(mapped.backStamp(), 0));
+    EXPECT_TRUE(mapped.ok());
+
+    // a copy has its own file
+    MappedStorage<Msg> copied(mapped);
+    EXPECT_TRUE(copied.push(6000, -1));
+    EXPECT_EQ(copied.back().second, -1);
+    EXPECT_EQ(mapped.back().second, 5998);
+    EXPECT_EQ(copied.front().second, mapped.front().second + 2);
+
+    // compaction cuts the file, so it shrinks with a sparser stream
+    using Mapped = MappedStorage<Msg>;
+    const uint64_t dense_size = mapped.fileSize();
+    for (Time t = 6000; t < 8000; t += 400) {
+      EXPECT_TRUE(mapped.push(t, int(t)));
+    }
+    EXPECT_LE(mapped.fileSize(),
+              (2 * mapped.size() + Mapped::kPageItems) * Mapped::kRecordSize);
+    EXPECT_LT(mapped.fileSize(), dense_size);
+
+    // a ref peek could outlive the cached page of its item
+    static_assert(!StableItems<Mapped>::value);
+    static_assert(StableItems<MapStorage<Msg>>::value);
+
+    // vectors of policies move it when they grow, a copy would copy the file
+    using MappedNear = NearestPolicy<
+        Msg, std::allocator<std::pair<const Time, Msg>>, MappedStorage<Msg>>;
+    static_assert(std::is_nothrow_move_constructible_v<Mapped>);
+    static_assert(std::is_nothrow_move_assignable_v<Mapped>);
+    static_assert(std::is_nothrow_move_constructible_v<MappedNear>);
+
+    Mapped moved(std::move(copied));
+    EXPECT_TRUE(moved.ok());
+    EXPECT_EQ(moved.back().second, -1);
+  }
+
+  { // policies use it unchanged
+    using SE3 = Eigen::Matrix<double, 7, 1>;
+    using Alloc = std::allocator<std::pair<const Time, SE3>>;
+    using Lerp = LinearInterpolatePolicy<SE3>;
+    using MappedLerp = LinearInterpolatePolicy<SE3, Alloc, MappedStorage<SE3>>;
+    using Near = NearestPolicy<Msg>;
+    using MappedNear = NearestPolicy<
+        Msg, std::allocator<std::pair<const Time, Msg>>, MappedStorage<Msg>>;
+
+    Lerp lerp(1e5, 10);
+    MappedLerp mapped_lerp(1e5, 10);
+    Near near(1e5, 3);
+    MappedNear mapped_near(1e5, 3);
+    for (Time t = 0; t < 3000; t += 5) {
+      const double yaw = 0.001 * t;
+      SE3 pose;
+      pose << 0.01 * t, 1, 2, std::cos(yaw / 2), 0, 0, std::sin(yaw / 2);
+      lerp.push(t, pose);
+      mapped_lerp.push(t, pose);
+      near.push(t, int(t));
+      mapped_near.push(t, int(t));
+    }
+    for (Time t = 0; t < 3010; t += 3) {
+      auto [out, status] = lerp.peek(t);
+      auto [mapped_out, mapped_status] = mapped_lerp.peek(t);
+      EXPECT_EQ(status, mapped_status);
+      EXPECT_TRUE(out.first.isApprox(mapped_out.first));
+      EXPECT_EQ(near.peek(t), mapped_near.peek(t));
+    }
+  }
+}
+
+TEST(StorageTest, PoolAllocator) {
+  using Msg = double;
+  using Alloc = PoolAllocator<std::pair<const Time, Msg>>;
+  using Policy = LinearInterpolatePolicy<Msg, Alloc>;
+  using Sync = SyncronizerMasterSlave<ExactTimePolicy<Msg, Alloc>, Policy>;
+
+  // 10 messages in window, pushed every 10
+  const auto pool =
+      std::make_shared<NodePool>(NodePool::capacityFor(100, 10, 2));
+  EXPECT_EQ(pool->capacity(), 26);
+  Sync sync(ExactTimePolicy<Msg, Alloc>(100, kMaster, Alloc(pool)),
+            Policy(100, 50, kNormal, Alloc(pool)));
+
+  size_t emitted = 0;
+  sync.registerCallback(
+      [&](const Time time, const std::pair<Msg, bool> &master,
+          const std::pair<Msg, bool> &slave) {
+        EXPECT_EQ(master.first, time);
+        EXPECT_NEAR(slave.first, time, 1e-9);
+        ++emitted;
+      });
+
+  size_t in_use = 0;
+  for (Time t = 0; t < 10000; t += 10) {
+    sync.push<1>(t, double(t));
+    sync.push<0>(t - 5, double(t - 5));
+    if (t == 1000) {
+      in_use = pool->nodesInUse();
+    }
+  }
+  EXPECT_GT(emitted, 900);
+
+  // one chunk for all, steady state needs no allocation
+  EXPECT_EQ(pool->chunkCount(), 1);
+  EXPECT_EQ(pool->fallbackCount(), 0);
+  EXPECT_EQ(pool->nodesInUse(), in_use);
+  EXPECT_LE(pool->highWater(), pool->capacity());
+
+  // arrays are not pooled, ring storage only allocates while growing
+  using RingAlloc = PoolAllocator<std::pair<Time, Msg>>;
+  NearestPolicy<Msg, RingAlloc, RingStorage<Msg, RingAlloc>> ring(
+      100, 50, kNormal, RingAlloc(pool));
+  for (Time t = 0; t < 1000; t += 10) {
+    EXPECT_TRUE(ring.push(t, double(t)));
+  }
+  const size_t fallbacks = pool->fallbackCount();
+  EXPECT_GT(fallbacks, 0);
+  for (Time t = 1000; t < 10000; t += 10) {
+    EXPECT_TRUE(ring.push(t, double(t)));
+  }
+  EXPECT_EQ(pool->fallbackCount(), fallbacks);
+  EXPECT_EQ(ring.peek(9987).first.first, 9990);
+
+  // over-aligned nodes come from chunks of their alignment
+  struct alignas(64) Wide {
+    double value;
+  };
+  using WideAlloc = PoolAllocator<std::pair<const Time, Wide>>;
+  const auto wide_pool = std::make_shared<NodePool>(8);
+  ExactTimeRefPolicy<Wide, WideAlloc> wide(1000, kNormal,
+                                           WideAlloc(wide_pool));
+  for (Time t = 0; t < 20; ++t) {
+    EXPECT_TRUE(wide.push(t, Wide{double(t)}));
+  }
+  for (Time t = 0; t < 20; ++t) {
+    const Wide *msg = wide.peek(t).first.first;
+    ASSERT_NE(msg, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(msg) % alignof(Wide), 0);
+    EXPECT_EQ(msg->value, t);
+  }
+  EXPECT_EQ(wide_pool->chunkCount(), 3);
+  EXPECT_EQ(wide_pool->fallbackCount(), 0);
+
+  // nodes are pooled by size, a single stamp allocated first by a mapped
+  // storage does not keep map nodes out of the pool
+  const auto shared = std::make_shared<NodePool>(16);
+  MappedStorage<Msg, Alloc> mapped(100, Alloc(shared));
+  EXPECT_TRUE(mapped.push(0, 0.0));
+  Policy policy(100, 50, kNormal, Alloc(shared));
+  const size_t before = shared->fallbackCount();
+  for (Time t = 0; t < 100; t += 10) {
+    EXPECT_TRUE(policy.push(t, double(t)));
+  }
+  EXPECT_EQ(shared->fallbackCount(), before);
+  EXPECT_EQ(shared->chunkCount(), 2);
+}
+
+TEST(StorageTest, ArenaAllocator) {
+  using Msg = int;
+  using Alloc = ArenaAllocator<std::pair<const Time, Msg>>;
+  using Policy = NearestPolicy<Msg, Alloc>;
+
+  Alloc alloc(1 << 16);
+  Policy policy(100, 5, kNormal, alloc);
+  for (Time t = 0; t < 100; ++t) {
+    EXPECT_TRUE(policy.push(t, int(t)));
+  }
+  EXPECT_EQ(alloc.arena()->blockCount(), 1);
+  const size_t used = alloc.arena()->bytesUsed();
+  EXPECT_GE(used, 100 * sizeof(std::pair<const Time, Msg>));
+
+  // copy shares the arena, freed nodes are not reused
+  Policy copied(policy);
+  EXPECT_EQ(copied.peek(50).first.first, 50);
+  EXPECT_GE(alloc.arena()->bytesUsed(), used * 2);
+
+  // a request larger than block gets its own
+  alloc.arena()->allocate(1 << 17, 8);
+  EXPECT_EQ(alloc.arena()->blockCount(), 2);
+}
+
+TEST(StorageTest, Evict) {
+  using Msg = int;
+
+  { // a gap evicts the whole expired window at once
+    MapStorage<Msg> map(10);
+    RingStorage<Msg> ring(10);
+    for (Time t = 0; t < 10; ++t) {
+      map.push(t, 0);
+      ring.push(t, 0);
+    }
+    EXPECT_EQ(map.size(), 10);
+    EXPECT_EQ(ring.size(), 10);
+
+    map.push(100, 0);
+    ring.push(100, 0);
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_EQ(ring.size(), 1);
+    EXPECT_EQ(map.frontStamp(), 100);
+    EXPECT_EQ(ring.frontStamp(), 100);
+  }
+
+  {
+    MapStorage<Msg> map(100);
+    RingStorage<Msg> ring(100);
+    for (Time t = 0; t < 10; ++t) {
+      map.push(t, 0);
+      ring.push(t, 0);
+    }
+
+    map.evictBefore(5);
+    ring.evictBefore(5);
+    EXPECT_EQ(map.size(), 5);
+    EXPECT_EQ(ring.size(), 5);
+    EXPECT_EQ(map.frontStamp(), 5);
+    EXPECT_EQ(ring.frontStamp(), 5);
+
+    map.evictBefore(100);
+    ring.evictBefore(100);
+    EXPECT_TRUE(map.empty());
+    EXPECT_TRUE(ring.empty());
+  }
+
+  { // syncronizer drops what could never be peeked once pivot advances
+    using Policy = ExactTimePolicy<Msg>;
+    using Sync = SyncronizerMasterSlave<Policy, Policy>;
+    Sync sync(Policy(1000, kMaster), Policy(1000));
+
+    for (Time t = 0; t < 100; ++t) {
+      sync.push<1>(t, 0);
+    }
+    EXPECT_EQ(sync.queueSize<1>(), 100);
+
+    EXPECT_EQ(sync.push<0>(50, 0), StatusCode::kMsgEmitted);
+    EXPECT_EQ(sync.timePivot(), 50);
+    EXPECT_EQ(sync.queueSize<0>(), 1);
+    EXPECT_EQ(sync.queueSize<1>(), 51);
+  }
+}
+
+TEST(StorageTest, Cursor) {
+  using Msg = int;
+
+  // queries wander back and forth around a forward moving time, compare
+  // against plain binary search over a sorted vector
+  auto check = [](auto &storage) {
+    std::vector<Time> stamps;
+    uint64_t seed = 7;
+    auto random = [&](const int n) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      return int((seed >> 33) % n);
+    };
+
+    Time time = 0;
+    for (int i = 0; i < 2000; ++i) {
+      time += 1 + random(5);
+      storage.push(time, int(time));
+      stamps.emplace_back(time);
+      if (random(50) == 0) {
+        storage.evictBefore(time - random(200));
+      }
+      while (stamps.front() < storage.frontStamp()) {
+        stamps.erase(stamps.begin());
+      }
+      ASSERT_EQ(storage.size(), stamps.size());
+
+      for (int j = 0; j < 3; ++j) {
+        const Time query =
+            random(10) == 0 ? time - random(300) : time - random(30);
+        auto upper = std::upper_bound(stamps.begin(), stamps.end(), query);
+
+        auto suc = storage.findSuc(query);
+        if (upper == stamps.end()) {
+          EXPECT_TRUE(suc == storage.end());
+        } else {
+          ASSERT_TRUE(suc != storage.end());
+          EXPECT_EQ(suc->first, *upper);
+        }
+
+        auto pre = storage.findPre(query);
+        if (upper == stamps.begin()) {
+          EXPECT_TRUE(pre == storage.end());
+        } else {
+          ASSERT_TRUE(pre != storage.end());
+          EXPECT_EQ(pre->first, *std::prev(upper));
+        }
+
+        auto found = storage.find(query);
+        if (upper != stamps.begin() && *std::prev(upper) == query) {
+          ASSERT_TRUE(found != storage.end());
+          EXPECT_EQ(found->second, query);
+        } else {
+          EXPECT_TRUE(found == storage.end());
+        }
+      }
+    }
+  };
+
+  {
+    MapStorage<Msg> map(500);
+    check(map);
+  }
+
+  {
+    RingStorage<Msg> ring(500);
+    check(ring);
+  }
+
+  { // copy does not share cursor
+    MapStorage<Msg> map(100);
+    map.push(0, 0);
+    map.push(1, 1);
+    map.findPre(1);
+    MapStorage<Msg> copied(map);
+    map.evictBefore(2);
+    EXPECT_EQ(copied.findPre(1)->second, 1);
+    EXPECT_EQ(copied.findSuc(0)->second, 1);
+  }
+
+  { // vectors of policies move storages when they grow
+    static_assert(std::is_nothrow_move_constructible_v<MapStorage<Msg>>);
+    static_assert(std::is_nothrow_move_constructible_v<NearestPolicy<Msg>>);
+    static_assert(
+        std::is_nothrow_move_constructible_v<LinearInterpolatePolicy<double>>);
+
+    MapStorage<Msg> map(100);
+    map.push(0, 0);
+    map.push(1, 1);
+    map.findPre(1);
+    MapStorage<Msg> moved(std::move(map));
+    EXPECT_EQ(moved.findPre(1)->second, 1);
+    EXPECT_TRUE(map.findPre(1) == map.end());
+  }
+}
+
+TEST(InterfaceTest, MovePush) {
+  using Msg = CopyCounter;
+  using Alloc = std::allocator<std::pair<const Time, Msg>>;
+
+  {
+    using Policy = ExactTimePolicy<Msg>;
+    using Sync = SyncronizerMasterSlave<Policy, Policy>;
+    Sync sync(Policy(10, kMaster), Policy(10));
+
+    CopyCounter::copies = 0;
+    Msg msg(1);
+    EXPECT_EQ(sync.push<1>(0, std::move(msg)), StatusCode::kMsgAccepted);
+    EXPECT_EQ(sync.push<1>(1, Msg(2)), StatusCode::kMsgAccepted);
+    EXPECT_EQ(sync.emplace<1>(2, 3), StatusCode::kMsgAccepted);
+    EXPECT_EQ(sync.emplace<1>(3, 2, 2), StatusCode::kMsgAccepted);
+    EXPECT_EQ(sync.emplace<1>(3, 5), StatusCode::kMsgDropped);
+    EXPECT_EQ(sync.queueSize<1>(), 4);
+    EXPECT_EQ(CopyCounter::copies, 0);
+
+    const Msg lvalue(5);
+    sync.push<1>(4, lvalue);
+    EXPECT_EQ(CopyCounter::copies, 1);
+  }
+
+  {
+    using Policy = ExactTimePolicy<Msg, Alloc, RingStorage<Msg, Alloc>>;
+    using Sync = SyncronizerMasterSlave<Policy, Policy>;
+    Sync sync(Policy(10, kMaster), Policy(10));
+
+    CopyCounter::copies = 0;
+    for (Time t = 0; t < 100; ++t) {
+      sync.push<1>(t, Msg(int(t)));
+      sync.emplace<1>(t, 0);
+    }
+    EXPECT_EQ(sync.queueSize<1>(), 11);
+    EXPECT_EQ(CopyCounter::copies, 0);
+  }
+
+  {
+    using Policy = ExactTimePolicy<Msg>;
+    using Sync = HomoSyncronizerMasterSlave<Policy>;
+    Sync sync(std::vector<Policy>{Policy(10, kMaster), Policy(10)});
+
+    CopyCounter::copies = 0;
+    sync.push(0, {Msg(1), 1});
+    sync.emplace(1, 1, 1, 1);
+    EXPECT_EQ(sync.queueSize(1), 2);
+    EXPECT_EQ(CopyCounter::copies, 0);
+  }
+}
+
+TEST(InterfaceTest, RefPeek) {
+  using Msg = CopyCounter;
+
+  { // peek hands out pointers into storage
+    using P0 = ExactTimeRefPolicy<Msg>;
+    using P1 = NearestRefPolicy<Msg>;
+    using P2 = NewestRefPolicy<Msg>;
+    using Sync = SyncronizerMasterSlave<P0, P1, P2>;
+    Sync sync(P0(10, kMaster), P1(10, 10), P2(10));
+
+    using Out = std::pair<const Msg *, bool>;
+    std::vector<int> values;
+    sync.registerCallback(
+        [&](const Time, const Out &m0, const Out &m1, const Out &m2) {
+          values.emplace_back(m0.first->value);
+          values.emplace_back(m1.first->value);
+          values.emplace_back(m2.first->value);
+        });
+
+    CopyCounter::copies = 0;
+    sync.emplace<0>(0, 1);
+    sync.emplace<1>(1, 2);
+    sync.emplace<2>(3, 3);
+    EXPECT_EQ(values, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(CopyCounter::copies, 0);
+  }
+
+  { // peek failed gives nullptr
+    using Policy = ExactTimeRefPolicy<Msg>;
+    Policy policy(10);
+    policy.emplace(0, 1);
+    const auto &[out, status] = policy.peek(1);
+    EXPECT_EQ(status, StatusCode::kPeekNotReady);
+    EXPECT_EQ(out.first, nullptr);
+    EXPECT_FALSE(out.second);
+  }
+
+  { // in policy array
+    using Policy = ExactTimeRefPolicy<Msg>;
+    using Sync = HomoSyncronizerMasterSlave<Policy>;
+    Sync sync(std::vector<Policy>{Policy(10, kMaster), Policy(10)});
+
+    std::vector<int> values;
+    sync.registerCallback(
+        [&](const Time, const std::vector<std::pair<const Msg *, bool>> &msgs) {
+          for (const auto &msg : msgs) {
+            values.emplace_back(msg.first->value);
+          }
+        });
+
+    CopyCounter::copies = 0;
+    sync.emplace(0, 0, 1);
+    sync.emplace(0, 1, 2);
+    EXPECT_EQ(values, (std::vector<int>{1, 2}));
+    EXPECT_EQ(CopyCounter::copies, 0);
+  }
+
+  { // shared handles works with copy mode
+    using Msg = std::shared_ptr<const CopyCounter>;
+    using Policy = ExactTimePolicy<Msg>;
+    using Sync = SyncronizerMasterSlave<Policy, Policy>;
+    Sync sync(Policy(10, kMaster), Policy(10));
+
+    std::vector<const CopyCounter *> ptrs;
+    sync.registerCallback([&](const Time, const std::pair<Msg, bool> &m0,
+                              const std::pair<Msg, bool> &m1) {
+      ptrs.emplace_back(m0.first.get());
+      ptrs.emplace_back(m1.first.get());
+    });
+
+    CopyCounter::copies = 0;
+    auto msg0 = std::make_shared<const CopyCounter>(1);
+    auto msg1 = std::make_shared<const CopyCounter>(2);
+    sync.push<0>(0, msg0);
+    sync.push<1>(0, msg1);
+    EXPECT_EQ(ptrs, (std::vector<const CopyCounter *>{msg0.get(), msg1.get()}));
+    EXPECT_EQ(CopyCounter::copies, 0);
+  }
+}
+
+TEST(InterfaceTest, InlineCallback) {
+  using Msg = int;
+  using Policy = ExactTimePolicy<Msg>;
+  using Out = std::pair<Msg, bool>;
+
+  {
+    std::vector<Time> emit_times;
+    auto sync = makeSyncronizerMinInterval(
+        10,
+        [&](const Time time, const Out &, const Out &) {
+          emit_times.emplace_back(time);
+        },
+        Policy(100), Policy(100));
+
+    sync.push<0>(0, 0);
+    EXPECT_EQ(sync.push<1>(0, 0), StatusCode::kMsgEmitted);
+    sync.push<0>(5, 0);
+    sync.push<1>(5, 0);
+    sync.push<0>(10, 0);
+    EXPECT_EQ(sync.push<1>(10, 0), StatusCode::kMsgEmitted);
+    EXPECT_EQ(emit_times, (std::vector<Time>{0, 10}));
+  }
+
+  {
+    std::vector<Time> emit_times;
+    auto sync = makeSyncronizerMasterSlave(
+        [&](const Time time, const Out &, const Out &) {
+          emit_times.emplace_back(time);
+        },
+        Policy(100, kMaster), Policy(100));
+
+    sync.push<1>(0, 0);
+    sync.push<1>(1, 0);
+    EXPECT_EQ(sync.push<0>(1, 0), StatusCode::kMsgEmitted);
+    EXPECT_EQ(emit_times, (std::vector<Time>{1}));
+  }
+
+  { // function object type as template parameter
+    struct Counter {
+      void operator()(const Time, const Out &, const Out &) { ++(*count); }
+      int *count;
+    };
+
+    int count = 0;
+    BasicSyncronizerMasterSlave<Counter, Policy, Policy> sync(
+        Counter{&count}, Policy(100, kMaster), Policy(100));
+    sync.push<0>(0, 0);
+    sync.push<1>(0, 0);
+    EXPECT_EQ(count, 1);
+  }
+}
+
+TEST(InterfaceTest, PolicyArrayPeek) {
+  using Msg = int;
+  using Policy = ExactTimePolicy<Msg>;
+  using Array = PolicyArray<Policy>;
+
+  Array array(std::vector<Policy>{Policy(100, kMaster), Policy(100),
+                                  Policy(100), Policy(100, kOptional)});
+  array.push(0, {1, 0});
+  array.push(0, {2, 1});
+
+  {
+    const auto &[out, status] = array.peek(0);
+    EXPECT_EQ(status, StatusCode::kPeekNotReady);
+    EXPECT_EQ(out.size(), 4);
+  }
+
+  array.push(1, {3, 1});
+  array.push(2, {4, 2});
+  { // policy 1 is ready, policy 2 expired
+    const auto &[out, status] = array.peek(0);
+    EXPECT_EQ(status, StatusCode::kPeekExpired);
+  }
+
+  array.push(2, {5, 0});
+  array.push(3, {6, 3});
+  const Array::OutType *buffer = nullptr;
+  { // policy 1 is not ready
+    const auto &[out, status] = array.peek(2);
+    EXPECT_EQ(status, StatusCode::kPeekNotReady);
+  }
+
+  array.push(3, {7, 0});
+  array.push(3, {8, 1});
+  array.push(3, {9, 2});
+  {
+    const auto &[out, status] = array.peek(3);
+    EXPECT_EQ(status, StatusCode::kPeekSuccess);
+    EXPECT_EQ(out,
+              (Array::OutType{{7, true}, {8, true}, {9, true}, {6, true}}));
+    buffer = &out;
+  }
+
+  array.push(4, {10, 0});
+  array.push(4, {11, 1});
+  array.push(4, {12, 2});
+  { // optional policy 3 is not ready, output buffer is reused
+    const auto &[out, status] = array.peek(4);
+    EXPECT_EQ(status, StatusCode::kPeekSuccess);
+    EXPECT_EQ(out,
+              (Array::OutType{{10, true}, {11, true}, {12, true}, {0, false}}));
+    EXPECT_EQ(&out, buffer);
+  }
+}
+
+TEST(InterfaceTest, ArenaPolicyArray) {
+  using Msg = int;
+  using Alloc = std::allocator<std::pair<const Time, Msg>>;
+  using Policy = NearestPolicy<Msg>;
+  using SlicePolicy = NearestPolicy<Msg, Alloc, SliceStorage<Msg>>;
+  using Out = std::vector<std::pair<Msg, bool>>;
+
+  { // same emissions as a plain policy array
+    using Sync =
+        SyncronizerMasterSlave<ExactTimePolicy<Msg>, PolicyArray<Policy>>;
+    using ArenaSync = SyncronizerMasterSlave<ExactTimePolicy<Msg>,
+                                             ArenaPolicyArray<SlicePolicy, 8>>;
+
+    std::vector<std::pair<Time, Out>> emitted, arena_emitted;
+    Sync sync(ExactTimePolicy<Msg>(1000, kMaster),
+              PolicyArray<Policy>(std::vector<Policy>(8, Policy(100, 4))));
+    ArenaSync arena_sync(ExactTimePolicy<Msg>(1000, kMaster),
+                         ArenaPolicyArray<SlicePolicy, 8>(SlicePolicy(100, 4),
+                                                          64));
+    sync.registerCallback([&](const Time time, const std::pair<Msg, bool> &,
+                              const Out &out) {
+      emitted.emplace_back(time, out);
+    });
+    arena_sync.registerCallback([&](const Time time,
+                                    const std::pair<Msg, bool> &,
+                                    const Out &out) {
+      arena_emitted.emplace_back(time, out);
+    });
+
+    for (Time t = 0; t < 300; ++t) {
+      const int id = (t * 5) % 8;
+      sync.push<1>(t, {int(t), id});
+      arena_sync.push<1>(t, {int(t), id});
+      if (t % 10 == 0) {
+        sync.push<0>(t, 0);
+        arena_sync.push<0>(t, 0);
+      }
+    }
+    EXPECT_FALSE(emitted.empty());
+    EXPECT_EQ(emitted, arena_emitted);
+  }
+
+  { // capacity drops the oldest, a copy has its own arena
+    std::vector<SlicePolicy> policies(3, SlicePolicy(1000, 1000));
+    ArenaPolicyArray<SlicePolicy> array(policies, 4);
+    EXPECT_EQ(array.capacity(), 4);
+    for (Time t = 0; t < 10; ++t) {
+      EXPECT_TRUE(array.push(t, {int(t), 1}));
+    }
+    EXPECT_EQ(array.queueSize(1), 4);
+    EXPECT_EQ(array.queueSize(0), 0);
+    EXPECT_EQ(array.droppedCount(1), 6);
+    EXPECT_EQ(array.droppedCount(0), 0);
+    MSYNC_STATS(EXPECT_EQ(array.stats(1).dropped, 6);
+                EXPECT_EQ(array.stats(1).accepted, 10);)
+
+    ArenaPolicyArray<SlicePolicy> copied(array);
+    array.push(10, {10, 1});
+    EXPECT_EQ(copied.peek(0).second, kPeekNotReady);
+    copied.push(10, {-10, 0});
+    copied.push(10, {-10, 1});
+    copied.push(10, {-10, 2});
+    EXPECT_EQ(copied.peek(7).first,
+              (Out{{-10, true}, {7, true}, {-10, true}}));
+    EXPECT_EQ(copied.peek(10).first,
+              (Out{{-10, true}, {-10, true}, {-10, true}}));
+    EXPECT_EQ(array.peek(10).second, kPeekNotReady);
+  }
+}
+
+TEST(InterfaceTest, PolicyArraySucTime) {
+  using Msg = int;
+  using Policy = ExactTimePolicy<Msg>;
+  using Array = PolicyArray<Policy>;
+
+  std::vector<Policy> policies;
+  for (int i = 0; i < 13; ++i) {
+    policies.emplace_back(Policy(50, i % 3 == 0 ? kMaster : kNormal));
+  }
+  Array array(policies);
+
+  EXPECT_EQ(array.sucTime(0, kNormal), std::numeric_limits<Time>::max());
+
+  // brute force reference
+  auto reference = [&](const Time time, const PolicyAttribute attr) {
+    Time suc = std::numeric_limits<Time>::max();
+    for (const auto &policy : policies) {
+      suc = std::min(suc, policy.sucTime(time, attr));
+    }
+    return suc;
+  };
+
+  Time query = 0;
+  for (Time t = 0; t < 500; ++t) {
+    const int id = (t * 7) % 13;
+    const bool accepted = array.push(t, {0, id});
+    EXPECT_EQ(accepted, policies[id].push(t, 0));
+
+    if (t % 5 == 0) {
+      query = t - 20 + (t * 3) % 17;
+    }
+    const PolicyAttribute attr = t % 50 < 25 ? kNormal : kMaster;
+    EXPECT_EQ(array.sucTime(query, attr), reference(query, attr));
+  }
+}
+
+TEST(InterfaceTest, Reorder) {
+  using Policy = ExactTimePolicy<int>;
+  using Out = std::pair<int, bool>;
+  using Sync = SyncronizerMasterSlave<Policy, Policy>;
+
+  { // policy holds messages back until newest stamp is window past them
+    Policy policy(100);
+    policy.setReorderWin(3);
+    EXPECT_TRUE(policy.push(0, 0));
+    EXPECT_TRUE(policy.push(2, 2));
+    EXPECT_TRUE(policy.push(1, 1));
+    EXPECT_FALSE(policy.push(1, 1));
+    EXPECT_EQ(policy.peek(0).second, kPeekNotReady);
+    EXPECT_TRUE(policy.push(4, 4));
+    EXPECT_EQ(policy.peek(1).first, Out(1, true));
+    EXPECT_EQ(policy.peek(2).second, kPeekNotReady);
+    EXPECT_FALSE(policy.push(0, 0));
+    EXPECT_EQ(policy.queueSize(), 4);
+    EXPECT_EQ(policy.reorderedCount(), 1);
+    EXPECT_EQ(policy.droppedCount(), 2);
+
+    // clock releases held ones window past it, eviction the ones before it
+    EXPECT_FALSE(policy.releaseHeld(4));
+    EXPECT_TRUE(policy.releaseHeld(5));
+    EXPECT_EQ(policy.peek(2).first, Out(2, true));
+    policy.evictBefore(4);
+    EXPECT_EQ(policy.peek(4).first, Out(4, true));
+    EXPECT_EQ(policy.queueSize(), 2);
+    EXPECT_FALSE(policy.push(3, 3));
+  }
+
+  // master at even stamps, slave at all, pairs swapped on arrival
+  std::vector<Time> emitted;
+  Policy master(100, kMaster), slave(100);
+  master.setReorderWin(4);
+  slave.setReorderWin(4);
+  Sync sync(master, slave);
+  sync.registerCallback([&](const Time time, const Out &a, const Out &b) {
+    EXPECT_EQ(a.first, time);
+    EXPECT_EQ(b.first, -time);
+    emitted.emplace_back(time);
+  });
+
+  for (Time t = 0; t < 100; t += 2) {
+    sync.push<1>(t + 1, -int(t + 1));
+    sync.push<1>(t, -int(t));
+    if (t % 4 == 0) {
+      sync.push<0>(t + 2, int(t + 2));
+      sync.push<0>(t, int(t));
+    }
+  }
+  EXPECT_EQ(sync.push<1>(90, -90), kMsgDropped);
+
+  std::vector<Time> expect;
+  for (Time t = 0; t <= 98 - 4; t += 2) {
+    expect.emplace_back(t);
+  }
+  EXPECT_EQ(emitted, expect);
+
+  // streams gone silent, tick releases the held tail as time goes
+  EXPECT_EQ(sync.tick(101), kMsgEmitted);
+  EXPECT_EQ(emitted.back(), 96);
+  EXPECT_EQ(sync.tick(102), kMsgEmitted);
+  EXPECT_EQ(emitted.back(), 98);
+  EXPECT_EQ(emitted.size(), expect.size() + 2);
+  EXPECT_EQ(sync.reorderedCount<0>(), 25);
+  EXPECT_EQ(sync.reorderedCount<1>(), 50);
+  EXPECT_EQ(sync.droppedCount<1>(), 1);
+}
+
+TEST(InterfaceTest, Tick) {
+  using Policy = ExactTimePolicy<int>;
+  using Out = std::pair<int, bool>;
+  using Sync = SyncronizerMasterSlave<Policy, Policy, Policy>;
+
+  Policy required(1000), optional(1000, kOptional);
+  required.setMaxLatency(50);
+  optional.setMaxLatency(20);
+
+  std::vector<std::pair<Time, bool>> emitted;
+  Sync sync(Policy(1000, kMaster), required, optional);
+  sync.registerCallback(
+      [&](const Time time, const Out &, const Out &a, const Out &b) {
+        EXPECT_TRUE(a.second);
+        emitted.emplace_back(time, b.second);
+      });
+
+  // fake clock, optional stream is silent
+  sync.push<0>(100, 0);
+  sync.push<1>(100, 0);
+  EXPECT_EQ(sync.tick(110), kMsgAccepted);
+  EXPECT_TRUE(emitted.empty());
+  EXPECT_EQ(sync.tick(120), kMsgEmitted);
+  EXPECT_EQ(emitted.back(), std::make_pair(Time(100), false));
+
+  // required stream is silent, candidate expires
+  sync.push<0>(200, 0);
+  sync.tick(240);
+  EXPECT_EQ(sync.timePivot(), 100);
+  sync.tick(250);
+  EXPECT_EQ(sync.timePivot(), 200);
+  sync.push<1>(200, 0);
+  sync.push<2>(200, 0);
+  EXPECT_EQ(emitted.size(), 1);
+
+  // all present, no tick needed
+  sync.push<1>(300, 0);
+  sync.push<2>(300, 0);
+  EXPECT_EQ(sync.push<0>(300, 0), kMsgEmitted);
+  EXPECT_EQ(emitted.back(), std::make_pair(Time(300), true));
+
+  // optional message missing at candidate but later ones arrived, see
+  // InterfaceTest.OptionalExpired
+  sync.push<1>(400, 0);
+  sync.push<2>(410, 0);
+  EXPECT_EQ(sync.push<0>(400, 0), kMsgEmitted);
+  EXPECT_EQ(emitted.back(), std::make_pair(Time(400), false));
+  EXPECT_EQ(emitted.size(), 3);
+}
+
+TEST(InterfaceTest, OptionalExpired) {
+  using Policy = ExactTimePolicy<int>;
+  using Out = std::pair<int, bool>;
+  using Sync = SyncronizerMasterSlave<Policy, Policy, Policy>;
+
+  std::vector<std::tuple<Time, bool, bool>> emitted;
+  Sync sync(Policy(1000, kMaster), Policy(1000), Policy(1000, kOptional));
+  sync.registerCallback(
+      [&](const Time time, const Out &, const Out &a, const Out &b) {
+        emitted.emplace_back(time, a.second, b.second);
+      });
+
+  // optional stream skipped stamp 100, its peek there is expired. this
+  // used to expire the candidate, nothing was emitted for 100, now the
+  // optional message is flagged as when its max latency passes
+  sync.push<1>(100, 0);
+  sync.push<2>(110, 0);
+  EXPECT_EQ(sync.push<0>(100, 0), kMsgEmitted);
+  EXPECT_EQ(emitted, (std::vector<std::tuple<Time, bool, bool>>{
+                         {100, true, false}}));
+
+  // an expired required peek still expires the candidate
+  sync.push<1>(210, 0);
+  sync.push<2>(200, 0);
+  EXPECT_EQ(sync.push<0>(200, 0), kMsgAccepted);
+  EXPECT_EQ(sync.timePivot(), 200);
+  EXPECT_EQ(emitted.size(), 1);
+}
+
+// sync_test_nostats builds this file without stats
+#ifdef MSYNC_ENABLE_STATS
+TEST(InterfaceTest, Stats) {
+  using Master = ExactTimePolicy<int>;
+  using Slave = NearestPolicy<int>;
+  using Out = std::pair<int, bool>;
+  using Sync = SyncronizerMasterSlave<Master, Slave>;
+
+  Sync sync(Master(1000, kMaster), Slave(1000, 10));
+  sync.registerCallback([](const Time, const Out &, const Out &) {});
+
+  // snapshots taken while pushing
+  std::atomic<bool> done(false);
+  std::thread reader([&] {
+    while (!done.load()) {
+      const auto stats = sync.stats();
+      EXPECT_LE(stats.emitted, stats.accepted);
+    }
+  });
+
+  // slave 3 after every other master
+  for (Time t = 0; t < 100; t += 10) {
+    sync.push<0>(t, 0);
+    if (t % 20 == 0)
+      sync.push<1>(t + 3, 0);
+  }
+  sync.push<1>(0, 0);
+  done.store(true);
+  reader.join();
+
+  const auto stats = sync.stats();
+  EXPECT_EQ(stats.accepted, 15);
+  EXPECT_EQ(stats.dropped, 1);
+  EXPECT_EQ(stats.emitted, 10);
+  EXPECT_EQ(stats.callback.count, 10);
+  EXPECT_EQ(stats.candidate_latency.count, 10);
+  EXPECT_GE(stats.not_ready, 1);
+
+  const auto slave = sync.policyStats<1>();
+  EXPECT_EQ(slave.accepted, 5);
+  EXPECT_EQ(slave.dropped, 1);
+  EXPECT_EQ(slave.peek_success, 10);
+  EXPECT_EQ(slave.skew.count, 10);
+  EXPECT_EQ(slave.skew.percentile(1.0), 7);
+  EXPECT_EQ(slave.high_water, 3);
+}
+#else
+// stats members vanish with the switch off
+static_assert(sizeof(NearestPolicy<double>) < sizeof(PolicyStats));
+static_assert(sizeof(SyncronizerMasterSlave<NearestPolicy<double>,
+                                            NearestPolicy<double>>) <
+              sizeof(SyncronizerStats));
+#endif
+
+TEST(InterfaceTest, TangentCache) {
+  using Policy = LinearInterpolatePolicy<BetweenCounter>;
+
+  Policy policy(1000, 100);
+  policy.push(0, {0.0});
+  policy.push(10, {10.0});
+  policy.push(20, {30.0});
+
+  // peeks within one segment compute its tangent once
+  BetweenCounter::betweens = 0;
+  for (Time t = 1; t < 10; ++t) {
+    auto [out, status] = policy.peek(t);
+    EXPECT_EQ(status, kPeekSuccess);
+    EXPECT_DOUBLE_EQ(out.first.value, t);
+  }
+  EXPECT_EQ(BetweenCounter::betweens, 1);
+
+  // next segment, then extrapolation on the same one
+  EXPECT_DOUBLE_EQ(policy.peek(15).first.first.value, 20.0);
+  EXPECT_DOUBLE_EQ(policy.peek(25).first.first.value, 40.0);
+  EXPECT_EQ(BetweenCounter::betweens, 2);
+
+  // a new message makes a new segment
+  policy.push(30, {30.0});
+  EXPECT_DOUBLE_EQ(policy.peek(25).first.first.value, 30.0);
+  EXPECT_DOUBLE_EQ(policy.peek(12).first.first.value, 14.0);
+  EXPECT_EQ(BetweenCounter::betweens, 4);
+}
+
+TEST(InterfaceTest, PeekBatch) {
+  using Quaternion = Eigen::Quaterniond;
+  using SE3 = Eigen::Matrix<double, 7, 1>;
+
+  LinearInterpolatePolicy<double> scalar(1000, 20);
+  LinearInterpolatePolicy<Quaternion> quaternion(1000, 20);
+  LinearInterpolatePolicy<SE3> se3(1000, 20);
+  for (Time t = 100; t <= 300; t += 10) {
+    const Quaternion q(
+        Eigen::AngleAxisd(0.01 * t, Eigen::Vector3d(1, 2, 3).normalized()));
+    SE3 pose;
+    pose << 0.1 * t, 0.2 * t, 1.0, q.w(), q.x(), q.y(), q.z();
+    scalar.push(t, 0.5 * t * t);
+    quaternion.push(t, q);
+    se3.push(t, pose);
+  }
+
+  // before first, exact hits, repeated, within predict window and past it
+  std::vector<Time> times{0, 99, 100, 101, 101, 105, 110};
+  for (Time t = 111; t < 330; t += 3) {
+    times.push_back(t);
+  }
+
+  const size_t n = times.size();
+  std::vector<std::pair<double, bool>> scalar_outs(n);
+  std::vector<std::pair<Quaternion, bool>> quaternion_outs(n);
+  std::vector<std::pair<SE3, bool>> se3_outs(n);
+  scalar.peekBatch(times.data(), n, scalar_outs.data());
+  quaternion.peekBatch(times.data(), n, quaternion_outs.data());
+  se3.peekBatch(times.data(), n, se3_outs.data());
+
+  for (size_t i = 0; i < n; ++i) {
+    const auto scalar_out = scalar.doPeek(times[i]);
+    EXPECT_EQ(scalar_outs[i].second, scalar_out.second) << times[i];
+    EXPECT_EQ(scalar_outs[i].second, times[i] >= 100 && times[i] <= 320);
+    if (scalar_out.second) {
+      EXPECT_NEAR(scalar_outs[i].first, scalar_out.first, 1e-9);
+    }
+
+    const auto quaternion_out = quaternion.doPeek(times[i]);
+    EXPECT_EQ(quaternion_outs[i].second, quaternion_out.second);
+    if (quaternion_out.second) {
+      EXPECT_TRUE(quaternion_outs[i].first.coeffs().isApprox(
+          quaternion_out.first.coeffs(), 1e-12));
+    }
+
+    const auto se3_out = se3.doPeek(times[i]);
+    EXPECT_EQ(se3_outs[i].second, se3_out.second);
+    if (se3_out.second) {
+      EXPECT_TRUE(se3_outs[i].first.isApprox(se3_out.first, 1e-12));
+    }
+  }
+
+  // unsorted times are peeked one by one
+  std::vector<Time> unsorted{250, 120, 400, 100};
+  std::vector<std::pair<double, bool>> unsorted_outs(unsorted.size());
+  scalar.peekBatch(unsorted.data(), unsorted.size(), unsorted_outs.data());
+  for (size_t i = 0; i < unsorted.size(); ++i) {
+    EXPECT_EQ(unsorted_outs[i], scalar.doPeek(unsorted[i]));
+  }
+}
+
+TEST(InterfaceTest, FastSlerp) {
+  using Quaternion = Eigen::Quaterniond;
+  using SE3 = Eigen::Matrix<double, 7, 1>;
+  using Exact = LinearInterpolaterTraits<Quaternion>;
+  using Fast = FastInterpolaterTraits<Quaternion>;
+
+  // zero tangent is identity
+  EXPECT_TRUE(Exact::Exp(Eigen::Vector3d::Zero()).coeffs().isApprox(
+      Quaternion::Identity().coeffs()));
+  const Eigen::Vector3d tiny(1e-9, -2e-9, 3e-9);
+  EXPECT_TRUE(Exact::Log(Exact::Exp(tiny)).isApprox(tiny, 1e-6));
+
+  // squared norm of this tangent underflows to 0, its vector part is still
+  // half of it instead of being lost
+  const Eigen::Vector3d underflow(3e-170, -4e-170, 0);
+  const Quaternion q = Exact::Exp(underflow);
+  EXPECT_DOUBLE_EQ(q.x() / underflow.x(), 0.5);
+  EXPECT_DOUBLE_EQ(q.y() / underflow.y(), 0.5);
+  EXPECT_EQ(q.w(), 1.0);
+
+  // accuracy contract, against exact slerp, polynomial below 1 rad and
+  // exact weights above, with ends in either hemisphere
+  const Eigen::Vector3d axis = Eigen::Vector3d(1, -2, 3).normalized();
+  const Quaternion from(Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX()));
+  for (double angle : {0.0, 1e-7, 0.01, 0.2, 0.99, 1.5, 3.0}) {
+    for (double sign : {1.0, -1.0}) {
+      Quaternion to = from * Quaternion(Eigen::AngleAxisd(angle, axis));
+      to.coeffs() *= sign;
+      const auto tangent = Fast::between(from, to);
+      for (double r = 0.0; r <= 1.0; r += 0.125) {
+        const Quaternion fast = Fast::plus(from, tangent * r);
+        const Quaternion exact = from.slerp(r, to);
+        // two weights off by 2e-12 each at most
+        EXPECT_NEAR(std::abs(fast.dot(exact)), 1.0, 4e-12);
+        EXPECT_NEAR(fast.norm(), 1.0, 4e-12);
+        EXPECT_LT(fast.angularDistance(exact), 1e-8);
+      }
+    }
+  }
+
+  // opt in policy agrees with the default one
+  LinearInterpolatePolicy<SE3> exact(1000, 10);
+  FastLinearInterpolatePolicy<SE3> fast(1000, 10);
+  for (Time t = 0; t <= 100; t += 10) {
+    const Quaternion q(Eigen::AngleAxisd(0.05 * t, axis));
+    SE3 pose;
+    pose << 0.1 * t, -0.2 * t, 1.0, q.w(), q.x(), q.y(), q.z();
+    exact.push(t, pose);
+    fast.push(t, pose);
+  }
+  for (Time t = 0; t <= 110; t += 3) {
+    const auto a = exact.doPeek(t);
+    const auto b = fast.doPeek(t);
+    EXPECT_EQ(a.second, b.second);
+    const Quaternion qa(a.first(3), a.first(4), a.first(5), a.first(6));
+    const Quaternion qb(b.first(3), b.first(4), b.first(5), b.first(6));
+    EXPECT_TRUE(a.first.head<3>().isApprox(b.first.head<3>(), 1e-12));
+    EXPECT_LT(qa.angularDistance(qb), 1e-8);
+  }
+}
+
+TEST(InterfaceTest, CubicInterpolate) {
+  using SE3 = Eigen::Matrix<double, 7, 1>;
+  using Quaternion = Eigen::Quaterniond;
+
+  { // exact for quadratic at even spacing, passes through messages
+    CubicInterpolatePolicy<double> cubic(1000, 10);
+    LinearInterpolatePolicy<double> linear(1000, 10);
+    for (Time t = 0; t <= 100; t += 10) {
+      cubic.push(t, 0.01 * t * t);
+      linear.push(t, 0.01 * t * t);
+    }
+    for (Time t = 10; t < 90; ++t) {
+      EXPECT_NEAR(cubic.doPeek(t).first, 0.01 * t * t, 1e-9) << t;
+    }
+    EXPECT_GT(std::abs(linear.doPeek(55).first - 0.01 * 55 * 55), 0.2);
+    EXPECT_DOUBLE_EQ(cubic.doPeek(40).first, 16.0);
+    EXPECT_FALSE(cubic.doPeek(-1).second);
+    EXPECT_TRUE(cubic.doPeek(110).second);
+    EXPECT_FALSE(cubic.doPeek(111).second);
+  }
+
+  { // turning, accelerating pose at uneven stamps
+    auto truth = [](const double t) {
+      const Quaternion q(Eigen::AngleAxisd(
+          0.02 * t + 1e-4 * t * t, Eigen::Vector3d(1, 2, 3).normalized()));
+      SE3 pose;
+      pose << std::sin(0.03 * t), 0.001 * t * t, 1.0, q.w(), q.x(), q.y(),
+          q.z();
+      return pose;
+    };
+    CubicInterpolatePolicy<SE3> cubic(10000, 10);
+    LinearInterpolatePolicy<SE3> linear(10000, 10);
+    for (Time t = 0; t <= 200; t += (t % 3 == 0 ? 7 : 9)) {
+      cubic.push(t, truth(t));
+      linear.push(t, truth(t));
+    }
+
+    // translation error plus rotation angle error
+    auto error = [](const SE3 &a, const SE3 &b) {
+      const Quaternion qa(a(3), a(4), a(5), a(6));
+      const Quaternion qb(b(3), b(4), b(5), b(6));
+      return (a.head<3>() - b.head<3>()).norm() + qa.angularDistance(qb);
+    };
+
+    // segments with both neighbours
+    double cubic_err = 0;
+    double linear_err = 0;
+    for (Time t = 16; t < 180; ++t) {
+      const auto out = cubic.doPeek(t);
+      ASSERT_TRUE(out.second);
+      cubic_err = std::max(cubic_err, error(out.first, truth(t)));
+      linear_err =
+          std::max(linear_err, error(linear.doPeek(t).first, truth(t)));
+    }
+    EXPECT_LT(cubic_err * 10, linear_err);
+  }
+
+  { // coefficients computed once per segment and neighbours
+    CubicInterpolatePolicy<BetweenCounter> cubic(1000, 100);
+    for (Time t = 0; t <= 30; t += 10) {
+      cubic.push(t, {double(t)});
+    }
+    BetweenCounter::betweens = 0;
+    for (Time t = 11; t < 20; ++t) {
+      EXPECT_DOUBLE_EQ(cubic.doPeek(t).first.value, t);
+    }
+    EXPECT_EQ(BetweenCounter::betweens, 3);
+
+    // last segment loses one sided tangent once next message comes
+    EXPECT_DOUBLE_EQ(cubic.doPeek(25).first.value, 25.0);
+    cubic.push(40, {40.0});
+    EXPECT_DOUBLE_EQ(cubic.doPeek(26).first.value, 26.0);
+    EXPECT_EQ(BetweenCounter::betweens, 8);
+  }
+}
+
+TEST(RecordTest, Replay) {
+  using SE3 = Eigen::Matrix<double, 7, 1>;
+  using Master = ExactTimePolicy<double>;
+  using Slave = LinearInterpolatePolicy<SE3>;
+  using Camera = PolicyArray<NearestPolicy<int>>;
+  using Sync = SyncronizerMasterSlave<Master, Slave, Camera>;
+  using Emission = std::tuple<Time, double, SE3, std::vector<int>>;
+
+  const std::string path = testing::TempDir() + "msync_record_test.log";
+
+  std::vector<Emission> emitted;
+  auto make = [&] {
+    Sync sync(Master(1000, kMaster), Slave(1000),
+              Camera({NearestPolicy<int>(1000, 5),
+                      NearestPolicy<int>(1000, 5)}));
+    sync.registerCallback(
+        [&](const Time time, const std::pair<double, bool> &a,
+            const std::pair<SE3, bool> &b,
+            const std::vector<std::pair<int, bool>> &c) {
+          emitted.emplace_back(time, a.first, b.first,
+                               std::vector<int>{c[0].first, c[1].first});
+        });
+    return sync;
+  };
+
+  size_t pushed = 0;
+  {
+    Sync sync = make();
+    SyncRecorder<Sync> recorder(sync, path);
+    ASSERT_TRUE(recorder.ok());
+    for (Time t = 0; t < 2000; ++t) {
+      SE3 pose;
+      pose << t, 0, 0, 1, 0, 0, 0;
+      recorder.push<1>(t, pose);
+      if (t % 3 == 0)
+        recorder.push<2>(t, {int(t), int(t % 2)});
+      if (t % 10 == 5)
+        recorder.push<0>(t, double(t));
+      pushed += 1 + (t % 3 == 0) + (t % 10 == 5);
+    }
+    recorder.push<0>(5, 0.0);
+    ++pushed;
+  }
+  const auto expect = emitted;
+  EXPECT_GT(expect.size(), 150);
+
+  // windows of one page, records cross window ends
+  emitted.clear();
+  Sync sync = make();
+  SyncReplayer<Sync> replayer(sync, path, 4096);
+  ASSERT_TRUE(replayer.ok());
+  EXPECT_EQ(replayer.replay(), pushed);
+  EXPECT_EQ(replayer.malformedCount(), 0);
+  EXPECT_FALSE(replayer.truncated());
+  EXPECT_EQ(emitted, expect);
+  EXPECT_EQ(sync.droppedCount<0>(), 1);
+
+  // log of other policies is refused
+  SyncronizerMinInterval<Master> other(10, Master(1000));
+  EXPECT_FALSE(SyncReplayer<decltype(other)>(other, path).ok());
+
+  { // a corrupt size past the end of file stops the read, nothing is
+    // allocated for it
+    std::FILE *file = std::fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    const uint32_t size = 0xffffffff;
+    std::fseek(file, kLogHeaderSize + 4, SEEK_SET);
+    std::fwrite(&size, sizeof(size), 1, file);
+    std::fclose(file);
+
+    Sync sync = make();
+    SyncReplayer<Sync> replayer(sync, path, 4096);
+    ASSERT_TRUE(replayer.ok());
+    EXPECT_EQ(replayer.replay(), 0);
+    EXPECT_TRUE(replayer.truncated());
+  }
+
+  { // a payload too large for a record is refused, not narrowed
+    LogWriter writer(path, 1);
+    ASSERT_TRUE(writer.ok());
+    EXPECT_FALSE(writer.append(0, 0, OversizedPayload()));
+    EXPECT_FALSE(writer.ok());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(ConcurrentTest, Stress) {
+  using Msg = int;
+  using Policy = ExactTimePolicy<Msg>;
+  using Out = std::pair<Msg, bool>;
+  constexpr Time kNumStamps = 20000;
+
+  { // one producer thread per stream
+    using Sync = SyncronizerMasterSlave<Policy, Policy, Policy>;
+
+    // stamps which every stream has
+    auto has = [](const int stream, const Time t) {
+      return stream == 0 ? t % 3 == 0 : (t + stream) % 5 != 0;
+    };
+
+    std::vector<Time> expect;
+    {
+      Sync sync(Policy(1e9, kMaster), Policy(1e9), Policy(1e9));
+      sync.registerCallback([&](const Time time, const Out &, const Out &,
+                                const Out &) { expect.emplace_back(time); });
+      for (Time t = 0; t < kNumStamps; ++t) {
+        if (has(0, t))
+          sync.push<0>(t, 0);
+        if (has(1, t))
+          sync.push<1>(t, 1);
+        if (has(2, t))
+          sync.push<2>(t, 2);
+      }
+    }
+    EXPECT_FALSE(expect.empty());
+
+    std::vector<Time> emitted;
+    ConcurrentSyncronizer<Sync> sync(Policy(1e9, kMaster), Policy(1e9),
+                                     Policy(1e9));
+    sync.syncronizer().registerCallback(
+        [&](const Time time, const Out &, const Out &, const Out &) {
+          emitted.emplace_back(time);
+        });
+
+    std::thread t0([&] {
+      for (Time t = 0; t < kNumStamps; ++t)
+        if (has(0, t))
+          sync.push<0>(t, 0);
+    });
+    std::thread t1([&] {
+      for (Time t = 0; t < kNumStamps; ++t)
+        if (has(1, t))
+          sync.push<1>(t, 1);
+    });
+    std::thread t2([&] {
+      for (Time t = 0; t < kNumStamps; ++t)
+        if (has(2, t))
+          sync.push<2>(t, 2);
+    });
+    t0.join();
+    t1.join();
+    t2.join();
+
+    EXPECT_EQ(emitted, expect);
+    EXPECT_EQ(sync.droppedCount(), 0);
+  }
+
+  { // many producers into a policy array, matched on a dedicated thread
+    using Sync = HomoSyncronizerMasterSlave<Policy>;
+    constexpr int kNumProducers = 6;
+
+    std::vector<Policy> policies{Policy(1e9, kMaster)};
+    for (int i = 1; i < kNumProducers; ++i) {
+      policies.emplace_back(Policy(1e9));
+    }
+
+    ConcurrentSyncronizer<Sync> sync(policies);
+    sync.setDriveOnPush(false);
+
+    std::vector<Time> emitted;
+    sync.syncronizer().registerCallback(
+        [&](const Time time, const std::vector<Out> &msgs) {
+          for (int i = 0; i < kNumProducers; ++i) {
+            EXPECT_EQ(msgs[i].first, i);
+          }
+          emitted.emplace_back(time);
+        });
+
+    std::atomic<bool> done(false);
+    std::thread matcher([&] {
+      while (!done.load()) {
+        sync.poll();
+      }
+      sync.poll();
+    });
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kNumProducers; ++i) {
+      producers.emplace_back([&, i] {
+        for (Time t = 0; t < kNumStamps; ++t) {
+          sync.push(t, {i, i});
+        }
+        // out of order one is dropped by syncronizer
+        sync.push(0, {i, i});
+      });
+    }
+    for (auto &producer : producers) {
+      producer.join();
+    }
+    done.store(true);
+    matcher.join();
+
+    std::vector<Time> expect(kNumStamps);
+    std::iota(expect.begin(), expect.end(), 0);
+    EXPECT_EQ(emitted, expect);
+    EXPECT_EQ(sync.droppedCount(), kNumProducers);
+  }
+}
+
+TEST(DispatchTest, Overflow) {
+  using Out = std::pair<int, bool>;
+  using Dispatcher = AsyncDispatcher<Out>;
+
+  // single worker held in the first callback until gate opens, queue of 2
+  auto run = [](const OverflowPolicy overflow,
+                std::vector<StatusCode> &status) {
+    std::vector<uint64_t> handled;
+    std::atomic<bool> gate(false);
+    Dispatcher dispatcher(
+        [&](const uint64_t seq, const Time, const Out &) {
+          while (!gate.load()) {
+            std::this_thread::yield();
+          }
+          handled.emplace_back(seq);
+        },
+        2, 1, overflow);
+
+    status.emplace_back(dispatcher.post(0, {0, true}));
+    while (dispatcher.queueSize() > 0) {
+      std::this_thread::yield();
+    }
+    for (Time t = 1; t < 4; ++t) {
+      status.emplace_back(dispatcher.post(t, {int(t), true}));
+    }
+    EXPECT_EQ(dispatcher.droppedCount(), 1);
+
+    gate.store(true);
+    dispatcher.flush();
+    return handled;
+  };
+
+  std::vector<StatusCode> status;
+  EXPECT_EQ(run(kOverflowDropNewest, status),
+            (std::vector<uint64_t>{0, 1, 2}));
+  EXPECT_EQ(status, (std::vector<StatusCode>{kDispatchAccepted,
+                                             kDispatchAccepted,
+                                             kDispatchAccepted,
+                                             kDispatchDropped}));
+
+  status.clear();
+  EXPECT_EQ(run(kOverflowDropOldest, status),
+            (std::vector<uint64_t>{0, 2, 3}));
+  EXPECT_EQ(status.back(), kDispatchReplaced);
+}
+
+TEST(DispatchTest, Order) {
+  using Policy = ExactTimePolicy<int>;
+  using Out = std::pair<int, bool>;
+  using Sync = SyncronizerMasterSlave<Policy, Policy>;
+  constexpr Time kNumStamps = 2000;
+
+  { // blocking single worker keeps emission order and loses nothing
+    std::vector<Time> emitted;
+    AsyncDispatcherOf<Sync> dispatcher(
+        [&](const uint64_t seq, const Time time, const Out &a,
+            const Out &b) {
+          EXPECT_EQ(seq, emitted.size());
+          EXPECT_EQ(a.first, time);
+          EXPECT_EQ(b.first, -time);
+          emitted.emplace_back(time);
+        },
+        4);
+
+    Sync sync(Policy(1e9, kMaster), Policy(1e9));
+    dispatcher.attach(sync);
+    for (Time t = 0; t < kNumStamps; ++t) {
+      sync.push<0>(t, int(t));
+      sync.push<1>(t, -int(t));
+    }
+    dispatcher.flush();
+
+    std::vector<Time> expect(kNumStamps);
+    std::iota(expect.begin(), expect.end(), 0);
+    EXPECT_EQ(emitted, expect);
+    EXPECT_EQ(dispatcher.droppedCount(), 0);
+  }
+
+  { // with more workers every sequence number is handled exactly once
+    std::vector<std::atomic<int>> handled(kNumStamps);
+    AsyncDispatcher<Out> dispatcher(
+        [&](const uint64_t seq, const Time, const Out &) {
+          handled[seq].fetch_add(1);
+        },
+        8, 4);
+    for (Time t = 0; t < kNumStamps; ++t) {
+      EXPECT_EQ(dispatcher.post(t, {0, true}), kDispatchAccepted);
+    }
+    dispatcher.flush();
+    for (const auto &count : handled) {
+      EXPECT_EQ(count.load(), 1);
+    }
+  }
+}
+
+TEST(DispatchTest, Status) {
+  using Policy = ExactTimePolicy<int>;
+  using Out = std::pair<int, bool>;
+  using Dispatcher = AsyncDispatcher<Out, Out>;
+
+  // worker held until gate opens, queue of 1 dropping newest, so statuses
+  // of emissions posted by a made syncronizer are seen by status callback
+  std::atomic<bool> gate(false);
+  std::vector<Time> handled;
+  Dispatcher dispatcher(
+      [&](const uint64_t, const Time time, const Out &, const Out &) {
+        while (!gate.load()) {
+          std::this_thread::yield();
+        }
+        handled.emplace_back(time);
+      },
+      1, 1, kOverflowDropNewest);
+
+  std::vector<std::pair<Time, StatusCode>> status;
+  dispatcher.registerStatusCallback(
+      [&](const uint64_t, const Time time, const StatusCode code) {
+        status.emplace_back(time, code);
+      });
+
+  auto sync = makeSyncronizerMasterSlave(dispatcher.poster(),
+                                         Policy(1e9, kMaster), Policy(1e9));
+  sync.push<0>(0, 0);
+  sync.push<1>(0, 0);
+  while (dispatcher.queueSize() > 0) {
+    std::this_thread::yield();
+  }
+  for (Time t = 1; t < 3; ++t) {
+    sync.push<0>(t, int(t));
+    sync.push<1>(t, int(t));
+  }
+  gate.store(true);
+  dispatcher.flush();
+
+  EXPECT_EQ(handled, (std::vector<Time>{0, 1}));
+  EXPECT_EQ(status, (std::vector<std::pair<Time, StatusCode>>{
+                        {0, kDispatchAccepted},
+                        {1, kDispatchAccepted},
+                        {2, kDispatchDropped}}));
+
+  { // stop from a callback refuses posts, destructor joins the worker
+    std::atomic<int> calls(0);
+    AsyncDispatcher<Out> stopping(
+        [&](const uint64_t, const Time, const Out &) {
+          ++calls;
+          stopping.stop();
+        },
+        4);
+    EXPECT_EQ(stopping.post(0, {0, true}), kDispatchAccepted);
+    while (calls.load() == 0) {
+      std::this_thread::yield();
+    }
+    while (stopping.post(1, {1, true}) != kDispatchDropped) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+using ReplayStream = std::vector<std::pair<Time, double>>;
+
+// pushing three streams merged by stamp one by one, the lower policy first
+// on a tie, emits the same as pushing them with pushBatches
+template <typename _Sync, typename _Make>
+static void expectBatchAsOneByOne(const _Make &make,
+                                  const std::array<ReplayStream, 3> &streams) {
+  using Out = std::pair<double, bool>;
+
+  std::vector<std::array<double, 4>> emitted;
+  auto record = [&](const Time time, const Out &a, const Out &b,
+                    const Out &c) {
+    emitted.push_back({double(time), a.first, b.first, c.first});
+  };
+
+  _Sync sync = make();
+  sync.registerCallback(record);
+  std::array<size_t, 3> pos{0, 0, 0};
+  while (true) {
+    int idx = -1;
+    for (int i = 2; i >= 0; --i) {
+      if (pos[i] < streams[i].size() &&
+          (idx < 0 ||
+           streams[i][pos[i]].first <= streams[idx][pos[idx]].first)) {
+        idx = i;
+      }
+    }
+    if (idx < 0)
+      break;
+    const auto &[time, msg] = streams[idx][pos[idx]++];
+    if (idx == 0)
+      sync.template push<0>(time, msg);
+    else if (idx == 1)
+      sync.template push<1>(time, msg);
+    else
+      sync.template push<2>(time, msg);
+  }
+  const auto merged = emitted;
+  EXPECT_GT(merged.size(), 1000);
+
+  emitted.clear();
+  _Sync batch = make();
+  batch.registerCallback(record);
+  EXPECT_EQ(batch.pushBatches(streams[0], streams[1], streams[2]),
+            streams[0].size() + streams[1].size() + streams[2].size());
+  EXPECT_EQ(emitted, merged);
+}
+
+TEST(BatchTest, Replay) {
+  using Master = NearestPolicy<double>;
+  using Slave = LinearInterpolatePolicy<double>;
+  using Out = std::pair<double, bool>;
+  using Sync = SyncronizerMasterSlave<Master, Slave, Master>;
+  using Stream = ReplayStream;
+
+  // irregular stamps, rate of stream i is about 1 / (3 + 4 * i)
+  uint32_t seed = 7;
+  std::array<Stream, 3> streams;
+  for (int i = 0; i < 3; ++i) {
+    for (Time t = 0; t < 20000;) {
+      streams[i].emplace_back(t, double(t));
+      seed = seed * 1664525u + 1013904223u;
+      t += 1 + (seed >> 16) % (6 + 8 * i);
+    }
+  }
+
+  std::vector<std::array<double, 4>> emitted;
+  auto make = [&]() {
+    Sync sync(Master(50, 3, kMaster), Slave(50, 10), Master(50, 3));
+    sync.registerCallback(
+        [&](const Time time, const Out &a, const Out &b, const Out &c) {
+          emitted.push_back({double(time), a.first, b.first, c.first});
+        });
+    return sync;
+  };
+
+  { // every policy kind emits as one by one, though history window is far
+    // shorter than the batch
+    expectBatchAsOneByOne<Sync>(make, streams);
+
+    using Cubic = CubicInterpolatePolicy<double>;
+    using Newest = NewestPolicy<double>;
+    expectBatchAsOneByOne<SyncronizerMasterSlave<Newest, Cubic, Master>>(
+        [] {
+          return SyncronizerMasterSlave<Newest, Cubic, Master>(
+              Newest(50, kMaster), Cubic(50, 10), Master(50, 3));
+        },
+        streams);
+
+    using Exact = ExactTimePolicy<double>;
+    expectBatchAsOneByOne<SyncronizerMasterSlave<Exact, Master, Slave>>(
+        [] {
+          return SyncronizerMasterSlave<Exact, Master, Slave>(
+              Exact(50, kMaster), Master(50, 3), Slave(50, 10));
+        },
+        streams);
+
+    expectBatchAsOneByOne<SyncronizerMinInterval<Slave, Master, Cubic>>(
+        [] {
+          return SyncronizerMinInterval<Slave, Master, Cubic>(
+              10, Slave(50, 10), Master(50, 3), Cubic(50, 10));
+        },
+        streams);
+  }
+
+  { // history window applies while a batch is pushed
+    Sync batch = make();
+    batch.pushBatches(streams[0], streams[1], streams[2]);
+    EXPECT_LE(batch.queueSize<1>(), 60);
+    EXPECT_EQ(batch.pushBatch<1>(Stream{{30000, 0.0}}), 1);
+    EXPECT_EQ(batch.queueSize<1>(), 1);
+  }
+
+  { // exact time policies emit exactly as one by one, rvalue ranges move
+    using Exact = ExactTimePolicy<std::vector<double>>;
+    using ExactOut = std::pair<std::vector<double>, bool>;
+    using ExactSync = SyncronizerMasterSlave<Exact, Exact>;
+    using ExactStream = std::vector<std::pair<Time, std::vector<double>>>;
+
+    ExactStream master, slave;
+    for (Time t = 0; t < 1000; ++t) {
+      slave.emplace_back(t, std::vector<double>(4, double(t)));
+      if (t % 3 == 0) {
+        master.emplace_back(t, std::vector<double>(4, double(t)));
+      }
+    }
+
+    std::vector<Time> expect, emitted;
+    ExactSync sync(Exact(20, kMaster), Exact(20));
+    sync.registerCallback(
+        [&](const Time time, const ExactOut &, const ExactOut &) {
+          expect.emplace_back(time);
+        });
+    size_t m = 0;
+    for (const auto &[time, msg] : slave) {
+      sync.push<1>(time, msg);
+      if (m < master.size() && master[m].first <= time) {
+        sync.push<0>(master[m].first, master[m].second);
+        ++m;
+      }
+    }
+
+    ExactSync batch(Exact(20, kMaster), Exact(20));
+    batch.registerCallback(
+        [&](const Time time, const ExactOut &a, const ExactOut &b) {
+          EXPECT_EQ(a.first.size(), 4);
+          EXPECT_EQ(b.first.size(), 4);
+          emitted.emplace_back(time);
+        });
+    EXPECT_EQ(batch.pushBatches(std::move(master), slave),
+              334 + slave.size());
+    EXPECT_EQ(emitted, expect);
+    EXPECT_TRUE(master.front().second.empty());
+    EXPECT_EQ(slave.front().second.size(), 4);
+  }
+
+  { // one stream after another, slaves first
+    emitted.clear();
+    Sync sync = make();
+    for (const auto &[time, msg] : streams[2])
+      sync.push<2>(time, msg);
+    for (const auto &[time, msg] : streams[1])
+      sync.push<1>(time, msg);
+    for (const auto &[time, msg] : streams[0])
+      sync.push<0>(time, msg);
+    const auto expect = emitted;
+
+    emitted.clear();
+    Sync batch = make();
+    batch.pushBatch<2>(streams[2]);
+    batch.pushBatch<1>(streams[1].begin(), streams[1].end());
+    Stream master = streams[0];
+    EXPECT_EQ(batch.pushBatch<0>(std::make_move_iterator(master.begin()),
+                                 std::make_move_iterator(master.end())),
+              master.size());
+    EXPECT_EQ(emitted, expect);
+
+    // non increasing stamps are dropped
+    EXPECT_EQ(batch.pushBatch<0>(Stream{{0, 0.0}, {1, 1.0}}), 0);
+  }
+}
+
+// sets of approximate time syncronizer over streams known in advance, for
+// each pivot every start stamp is tried, the set of a start takes the first
+// message of each stream no earlier than it
+static std::vector<std::vector<Time>>
+approximateTimeSets(const std::vector<std::vector<Time>> &streams) {
+  std::vector<std::vector<Time>> sets;
+  std::vector<size_t> pos(streams.size(), 0);
+  while (true) {
+    size_t pivot = 0;
+    for (size_t i = 0; i < streams.size(); ++i) {
+      if (pos[i] == streams[i].size())
+        return sets;
+      if (streams[i][pos[i]] > streams[pivot][pos[pivot]])
+        pivot = i;
+    }
+    const Time pivot_time = streams[pivot][pos[pivot]];
+
+    std::vector<size_t> best;
+    Time best_spread = std::numeric_limits<Time>::max();
+    Time best_start = 0;
+    for (size_t j = 0; j < streams.size(); ++j) {
+      for (size_t k = pos[j];
+           k < streams[j].size() && streams[j][k] <= pivot_time; ++k) {
+        const Time start = streams[j][k];
+        std::vector<size_t> set(streams.size());
+        Time end = start;
+        bool full = true;
+        for (size_t i = 0; i < streams.size(); ++i) {
+          set[i] = std::lower_bound(streams[i].begin() + pos[i],
+                                    streams[i].end(), start) -
+                   streams[i].begin();
+          if (set[i] == streams[i].size()) {
+            full = false;
+            break;
+          }
+          end = std::max(end, streams[i][set[i]]);
+        }
+        // on equal spread the earlier start wins
+        if (full && (end - start < best_spread ||
+                     (end - start == best_spread && start < best_start))) {
+          best_spread = end - start;
+          best_start = start;
+          best = set;
+        }
+      }
+    }
+
+    sets.emplace_back();
+    for (size_t i = 0; i < streams.size(); ++i) {
+      sets.back().emplace_back(streams[i][best[i]]);
+      pos[i] = best[i] + 1;
+    }
+  }
+}
+
+TEST(ApproximateTimeTest, Reference) {
+  using Policy = ExactTimePolicy<int>;
+  using Out = std::pair<int, bool>;
+  using Sync = SyncronizerApproximateTime<Policy, Policy, Policy>;
+
+  // jittered streams at different rates
+  uint32_t seed = 11;
+  std::vector<std::vector<Time>> streams(3);
+  for (int i = 0; i < 3; ++i) {
+    for (Time t = 3 * i; t < 20000;) {
+      streams[i].emplace_back(t);
+      seed = seed * 1664525u + 1013904223u;
+      t += 10 + 7 * i + (seed >> 16) % 9;
+    }
+  }
+  const auto expect = approximateTimeSets(streams);
+
+  std::vector<std::vector<Time>> emitted;
+  Sync sync(Policy(1e9), Policy(1e9), Policy(1e9));
+  sync.registerCallback(
+      [&](const Time time, const Out &a, const Out &b, const Out &c) {
+        EXPECT_EQ(time, std::max({a.first, b.first, c.first}));
+        emitted.push_back({a.first, b.first, c.first});
+      });
+
+  std::vector<size_t> pos(3, 0);
+  while (true) {
+    int idx = -1;
+    for (int i = 0; i < 3; ++i) {
+      if (pos[i] < streams[i].size() &&
+          (idx < 0 || streams[i][pos[i]] < streams[idx][pos[idx]]))
+        idx = i;
+    }
+    if (idx < 0)
+      break;
+    const Time time = streams[idx][pos[idx]++];
+    if (idx == 0)
+      sync.push<0>(time, time);
+    else if (idx == 1)
+      sync.push<1>(time, time);
+    else
+      sync.push<2>(time, time);
+  }
+
+  EXPECT_GT(emitted.size(), 500);
+  EXPECT_LE(emitted.size(), expect.size());
+  EXPECT_GE(emitted.size() + 2, expect.size());
+  EXPECT_TRUE(std::equal(emitted.begin(), emitted.end(), expect.begin()));
+
+  // a batch of short history window matches the same sets
+  const auto one_by_one = emitted;
+  emitted.clear();
+  Sync batch(Policy(100), Policy(100), Policy(100));
+  batch.registerCallback(
+      [&](const Time, const Out &a, const Out &b, const Out &c) {
+        emitted.push_back({a.first, b.first, c.first});
+      });
+  std::array<std::vector<std::pair<Time, int>>, 3> items;
+  for (int i = 0; i < 3; ++i) {
+    for (const Time time : streams[i]) {
+      items[i].emplace_back(time, int(time));
+    }
+  }
+  batch.pushBatches(items[0], items[1], items[2]);
+  EXPECT_EQ(emitted, one_by_one);
+}
+
+TEST(ApproximateTimeTest, LowerBound) {
+  using Policy = ExactTimePolicy<int>;
+  using Out = std::pair<int, bool>;
+
+  std::vector<std::pair<int, int>> emitted;
+  auto sync = makeSyncronizerApproximateTime(
+      [&](const Time, const Out &a, const Out &b) {
+        emitted.emplace_back(a.first, b.first);
+      },
+      Policy(1000), Policy(1000));
+
+  // without bounds the next message of stream 0 may pair better with 3
+  sync.push<0>(0, 0);
+  sync.push<1>(3, 3);
+  EXPECT_TRUE(emitted.empty());
+  sync.push<0>(10, 10);
+  EXPECT_EQ(emitted, (std::vector<std::pair<int, int>>{{0, 3}}));
+
+  // stream 0 is known to be at least 10 apart, 13 can not be beaten
+  sync.setInterMessageLowerBound(0, 10);
+  EXPECT_EQ(sync.push<1>(13, 13), kMsgEmitted);
+  EXPECT_EQ(emitted.back(), std::make_pair(10, 13));
+
+  // too wide sets are skipped
+  sync.setMaxInterval(5);
+  sync.push<0>(20, 20);
+  sync.push<0>(30, 30);
+  sync.push<1>(31, 31);
+  EXPECT_EQ(emitted.back(), std::make_pair(30, 31));
+  EXPECT_EQ(emitted.size(), 3);
+}
+
+TEST(ApproximateTimeTest, Tick) {
+  using Policy = ExactTimePolicy<int>;
+  using Out = std::pair<int, bool>;
+
+  std::vector<std::pair<int, int>> emitted;
+  Policy silent(1000);
+  silent.setMaxLatency(4);
+  auto sync = makeSyncronizerApproximateTime(
+      [&](const Time, const Out &a, const Out &b) {
+        emitted.emplace_back(a.first, b.first);
+      },
+      silent, Policy(1000));
+
+  // stream 0 may still get a stamp before 6, pairing better with 3 than 0
+  // does, until the clock is its max latency past 6
+  sync.push<0>(0, 0);
+  sync.push<1>(3, 3);
+  EXPECT_EQ(sync.tick(9), kMsgAccepted);
+  EXPECT_TRUE(emitted.empty());
+  EXPECT_EQ(sync.tick(10), kMsgEmitted);
+  EXPECT_EQ(emitted, (std::vector<std::pair<int, int>>{{0, 3}}));
+}
+
 TEST(MinIntervalPatternTest, Sanity) {
   using Msg = int;
   using Policy =